@@ -0,0 +1,15 @@
+%inline %{
+class MyClass {
+public:
+    MyClass () {}
+    MyClass (int, int, int) {}
+    ~MyClass () {}
+    int func0 () { return 0; }
+    int func1 (int a) { return a; }
+    int func3 (int a, int b, int c) { return a + b + c; }
+    int over (int a) { return a; }
+    int over (int a, int b, int c) { return a + b + c; }
+};
+
+int func3 (int a, int b, int c) { return a + b + c; }
+%}
@@ -0,0 +1,25 @@
+# Call overhead of methods taking 0, 1 and 3 arguments, of an overloaded
+# method and of a constructor, with and without -fastcall.
+import importlib
+import sys
+import timeit
+
+modules = sys.argv[1:] or ["Simple_optimized", "Simple_fastcall",
+                           "Simple_builtin", "Simple_builtin_fastcall"]
+calls = [
+    ("x.func0()", "0 args"),
+    ("x.func1(1)", "1 arg"),
+    ("x.func3(1, 2, 3)", "3 args"),
+    ("x.over(1, 2, 3)", "overloaded"),
+    ("func3(1, 2, 3)", "function"),
+    ("MyClass(1, 2, 3)", "constructor"),
+]
+number = 1000000
+
+print("%-24s" % "ns/call" + "".join("%12s" % label for _, label in calls))
+for name in modules:
+    mod = importlib.import_module(name)
+    namespace = {"x": mod.MyClass(), "func3": mod.func3, "MyClass": mod.MyClass}
+    times = [min(timeit.repeat(stmt, globals=namespace, number=number, repeat=5)) * 1e9 / number
+             for stmt, _ in calls]
+    print("%-24s" % name + "".join("%12.1f" % t for t in times))
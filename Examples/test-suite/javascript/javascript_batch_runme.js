@@ -0,0 +1,45 @@
+// The module is built with -cocos, so this runs inside the cocos script engine
+// rather than the node test-suite.
+var javascript_batch = require("javascript_batch");
+
+function check(a, b) {
+  if (a !== b) {
+    throw new Error("Not equal: " + a + " " + b)
+  }
+}
+
+var N = 10000;
+var nodes = [];
+var xs = new Float32Array(N);
+var ys = [];
+for (var i = 0; i < N; i++) {
+  nodes.push(new javascript_batch.Node());
+  xs[i] = i;
+  ys.push(-i);
+}
+
+// one call crosses into native code for all the nodes
+javascript_batch.Node.setPositionBatch(nodes, xs, ys);
+check(5, nodes[5].x);
+check(-5, nodes[5].y);
+
+var result = javascript_batch.Node.getXBatch(nodes);
+check(N, result.length);
+check(N - 1, result[N - 1]);
+
+javascript_batch.Node.setNameBatch(nodes.slice(0, 2), ["a", "b"]);
+check("b", nodes[1].name);
+
+result = javascript_batch.Node.clampBatch(new Int32Array([-5, 5, 50]), [0, 0, 0], [10, 10, 10]);
+check(0, result[0]);
+check(5, result[1]);
+check(10, result[2]);
+
+// the arrays must have the same length
+var failed = false;
+try {
+  javascript_batch.Node.setPositionBatch(nodes, xs, [1]);
+} catch (e) {
+  failed = true;
+}
+check(true, failed);
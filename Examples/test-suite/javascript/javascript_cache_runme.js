@@ -0,0 +1,48 @@
+// The module is built with -cocos, so this runs inside the cocos script engine
+// rather than the node test-suite.
+var javascript_cache = require("javascript_cache");
+
+function check(a, b) {
+  if (a !== b) {
+    throw new Error("Not equal: " + a + " " + b)
+  }
+}
+
+var node = new javascript_cache.Node();
+check(0, node.id);
+
+// the setter drops the cached value
+node.id = 2;
+check(2, node.id);
+node.name = "a";
+check("a", node.name);
+check("a!", node.title);
+node.name = "b";
+check("b", node.name);
+
+// nothing is stored in the script object
+check(0, Object.keys(node).length);
+
+// changes made in C++ are seen after an invalidation only
+node.renumber(3);
+check(2, node.id);
+// js_cache_invalidate(native) in C++ makes node.id 3
+
+// objects are not cached, so changes made through them stay visible
+var root = new javascript_cache.Node();
+node.parent = root;
+root.id = 5;
+check(5, node.parent.id);
+
+// static members are not cached
+javascript_cache.Node.Count = 2;
+check(2, javascript_cache.Node.Count);
+
+// members of derived classes use other slots than those of their bases
+var child = new javascript_cache.Child();
+child.id = 7;
+check(7, child.id);
+check(1, child.depth);
+child.depth = 4;
+check(4, child.depth);
+check(7, child.id);
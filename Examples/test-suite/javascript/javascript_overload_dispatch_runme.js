@@ -0,0 +1,24 @@
+// The module is built with -cocos, so this runs inside the cocos script engine
+// rather than the node test-suite.
+var javascript_overload_dispatch = require("javascript_overload_dispatch");
+
+function check(a, b) {
+  if (a !== b) {
+    throw new Error("Not equal: " + a + " " + b)
+  }
+}
+
+check("int", javascript_overload_dispatch.number(2));
+check("double", javascript_overload_dispatch.number(2.5));
+
+check("int", javascript_overload_dispatch.integer(2));
+check("int", javascript_overload_dispatch.integer(1.5));
+check("string", javascript_overload_dispatch.integer("a"));
+
+check("int64", javascript_overload_dispatch.wide(2));
+check("int64", javascript_overload_dispatch.wide(BigInt(2)));
+check("string", javascript_overload_dispatch.wide("a"));
+
+check("bool", javascript_overload_dispatch.flag(true));
+check("bool", javascript_overload_dispatch.flag(1));
+check("string", javascript_overload_dispatch.flag("a"));
@@ -0,0 +1,31 @@
+// The module is built with -cocos, so this runs inside the cocos script engine
+// rather than the node test-suite.
+var javascript_pool = require("javascript_pool");
+
+function check(a, b) {
+  if (a !== b) {
+    throw new Error("Not equal: " + a + " " + b)
+  }
+}
+
+var node = new javascript_pool.Node();
+node.position = new javascript_pool.Vec3(1, 2, 3);
+
+// a recycled object is handed out by the next call
+var p = node.getPosition();
+check(1, p.x);
+javascript_pool.Vec3.recycle(p);
+var q = node.position;
+check(p, q);
+check(2, q.y);
+
+// an object of the class passed as extra argument receives the result
+var out = new javascript_pool.Vec3();
+check(out, node.offset(10, out));
+check(11, out.x);
+check(out, node.getPosition(out));
+check(1, out.x);
+
+// the free list only takes objects of the class
+javascript_pool.Vec3.recycle(node, 5, null);
+check(false, node.getPosition() === node);
@@ -0,0 +1,58 @@
+// Benchmark of the typed array bridge in typedarray.i against the element-wise
+// conversion. The module is built with -cocos, so this runs inside the cocos
+// script engine rather than the node test-suite.
+var javascript_typedarray = require("javascript_typedarray");
+
+var N = 4096;
+var ITERATIONS = 2000;
+
+function check(a, b) {
+  if (a !== b) {
+    throw new Error("Not equal: " + a + " " + b)
+  }
+}
+
+function now() {
+  return (typeof performance !== "undefined") ? performance.now() : Date.now();
+}
+
+function bench(name, fn) {
+  var result;
+  var start = now();
+  for (var i = 0; i < ITERATIONS; i++) {
+    result = fn();
+  }
+  var ms = now() - start;
+  console.log(name + ": " + (ms * 1000 / ITERATIONS).toFixed(2) + " us/call");
+  return result;
+}
+
+var plain = [];
+for (var i = 0; i < N; i++) {
+  plain.push(1);
+}
+var typed = new Float32Array(plain);
+
+// script to native
+check(N, bench("elements in   (Array)       ", function() { return javascript_typedarray.sumElements(plain); }));
+check(N, bench("vector in     (Array)       ", function() { return javascript_typedarray.sumVector(plain); }));
+check(N, bench("vector in     (Float32Array)", function() { return javascript_typedarray.sumVector(typed); }));
+check(N, bench("data in       (borrowed)    ", function() { return javascript_typedarray.sumData(typed); }));
+
+// native to script
+check(N, bench("elements out  (Array)       ", function() { return javascript_typedarray.makeElements(N); }).length);
+check(N, bench("vector out    (copied)      ", function() { return javascript_typedarray.makeVector(N); }).length);
+check(N, bench("vector out    (adopted)     ", function() { return javascript_typedarray.makeAdopted(N); }).length);
+
+var buffer = new javascript_typedarray.Buffer(N);
+var values = bench("vector& out   (wrapped)     ", function() { return buffer.values(); });
+check(N, values.length);
+check(true, values instanceof Float32Array);
+
+// writes to a copied const result do not reach the vector
+var copy = buffer.constValues();
+check(true, copy instanceof Float32Array);
+copy[0] = 2;
+check(1, buffer.constValues()[0]);
+values[0] = 3;
+check(3, buffer.constValues()[0]);
@@ -0,0 +1,28 @@
+%module javascript_batch
+
+// Methods with a <name>Batch companion taking arrays of arguments, see
+// javascript_batch_runme.js.
+
+#ifdef SWIGCOCOS
+%js_batch(Node::setPosition);
+%js_batch(Node::getX);
+%js_batch(Node::setName);
+%js_batch(Node::clamp);
+#endif
+
+%include <std_string.i>
+
+%inline %{
+#include <string>
+
+struct Node {
+  Node() : x(0), y(0) {}
+  float x;
+  float y;
+  std::string name;
+  void setPosition(float px, float py) { x = px; y = py; }
+  float getX() const { return x; }
+  void setName(const std::string &n) { name = n; }
+  static int clamp(int v, int lo, int hi) { return v < lo ? lo : (v > hi ? hi : v); }
+};
+%}
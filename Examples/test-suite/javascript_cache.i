@@ -0,0 +1,51 @@
+%module javascript_cache
+
+// Members whose converted value is kept in a native slot of the script
+// object, see javascript_cache_runme.js.
+
+#ifdef SWIGCOCOS
+%js_cache(Node::name);
+%js_cache(Node::id);
+%js_cache(Node::title);
+%js_cache(Node::Count);
+// only numbers, booleans and strings are cached
+%warnfilter(SWIGWARN_JS_CACHE_IGNORED) Node::parent;
+%warnfilter(SWIGWARN_JS_CACHE_IGNORED) Node::pos;
+%js_cache(Node::parent);
+%js_cache(Node::pos);
+%js_cache(Child::depth);
+#endif
+
+%include <std_string.i>
+%include <attribute.i>
+
+%attributestring(Node, std::string, title, getTitle);
+
+%inline %{
+#include <string>
+
+struct Pos {
+  Pos() : x(0), y(0) {}
+  double x, y;
+};
+
+struct Node {
+  Node() : parent(0), id(0) {}
+  Node *parent;
+  Pos pos;
+  std::string name;
+  int id;
+  static int Count;
+  std::string getTitle() const { return name + "!"; }
+  // changes id behind the back of the script
+  void renumber(int i) { id = i; }
+};
+
+int Node::Count = 0;
+
+// shares the cache slots of its script object with the members of Node
+struct Child : Node {
+  Child() : depth(1) {}
+  int depth;
+};
+%}
@@ -0,0 +1,26 @@
+%module javascript_overload_dispatch
+
+// Overloads dispatched with the typecheck typemaps, see
+// javascript_overload_dispatch_runme.js.
+
+%include <stdint.i>
+
+%inline %{
+#include <stdint.h>
+
+// the strict checks rank the integer overload after the number without a fraction
+const char *number(int) { return "int"; }
+const char *number(double) { return "double"; }
+
+// 1.5 only passes the loose check of int
+const char *integer(int) { return "int"; }
+const char *integer(const char *) { return "string"; }
+
+// a BigInt passes the strict check of 64-bit integers
+const char *wide(int64_t) { return "int64"; }
+const char *wide(const char *) { return "string"; }
+
+// a number only passes the loose check of bool
+const char *flag(bool) { return "bool"; }
+const char *flag(const char *) { return "string"; }
+%}
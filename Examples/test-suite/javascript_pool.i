@@ -0,0 +1,24 @@
+%module javascript_pool
+
+// Value type whose returned script objects are recycled, see
+// javascript_pool_runme.js.
+
+#ifdef SWIGCOCOS
+%js_pool(Vec3);
+#endif
+
+%inline %{
+struct Vec3 {
+  Vec3() : x(0), y(0), z(0) {}
+  Vec3(float px, float py, float pz) : x(px), y(py), z(pz) {}
+  float x;
+  float y;
+  float z;
+};
+
+struct Node {
+  Vec3 position;
+  Vec3 getPosition() const { return position; }
+  Vec3 offset(float dx) const { return Vec3(position.x + dx, position.y, position.z); }
+};
+%}
@@ -0,0 +1,62 @@
+%module javascript_typedarray
+
+// Typed array bridge for std::vector and C arrays, compared against the
+// element-wise conversion by javascript_typedarray_runme.js.
+
+#ifdef SWIGCOCOS
+%include <typedarray.i>
+
+%apply (const float *DATA, size_t LENGTH) { (const float *data, size_t count) }
+
+// keep the element-wise conversion for these, as the baseline
+%typemap(in) const std::vector<float> &elements = SWIGTYPE &;
+%typemap(out) std::vector<float> makeElements = SWIGTYPE;
+
+%feature("js:typedarray", "adopt") makeAdopted;
+%feature("js:typedarray", "wrap") Buffer::values;
+// const results are copied rather than exposed to writes from script
+%feature("js:typedarray", "wrap") Buffer::constValues;
+#endif
+
+%{
+#include <vector>
+%}
+
+%inline %{
+float sumVector(const std::vector<float> &values) {
+  float sum = 0;
+  for (size_t i = 0; i < values.size(); i++)
+    sum += values[i];
+  return sum;
+}
+
+float sumElements(const std::vector<float> &elements) {
+  return sumVector(elements);
+}
+
+float sumData(const float *data, size_t count) {
+  float sum = 0;
+  for (size_t i = 0; i < count; i++)
+    sum += data[i];
+  return sum;
+}
+
+std::vector<float> makeVector(size_t n) {
+  return std::vector<float>(n, 1.0f);
+}
+
+std::vector<float> makeElements(size_t n) {
+  return makeVector(n);
+}
+
+std::vector<float> makeAdopted(size_t n) {
+  return makeVector(n);
+}
+
+struct Buffer {
+  std::vector<float> data;
+  Buffer(size_t n) : data(n, 1.0f) {}
+  std::vector<float> &values() { return data; }
+  const std::vector<float> &constValues() const { return data; }
+};
+%}
@@ -0,0 +1,106 @@
+from python_fastcall import *
+
+def check(got, expected):
+    if got != expected:
+        raise RuntimeError("got {!r}, expected {!r}".format(got, expected))
+
+def check_raises(exc, func, *args, **kwargs):
+    try:
+        func(*args, **kwargs)
+    except exc:
+        return
+    raise RuntimeError("{} not raised".format(exc.__name__))
+
+# overloaded constructors
+check((Point().x, Point().y), (0, 0))
+check((Point(3).x, Point(3).y), (3, 3))
+check((Point(3, 4).x, Point(3, 4).y), (3, 4))
+check(Point(Point(5, 6)).y, 6)
+check_raises(TypeError, Point, 1, 2, 3)
+check_raises(TypeError, Point, "x")
+
+# a constructor with keyword arguments and defaults
+check((Shape().name, Shape().sides), ("polygon", 0))
+s = Shape("square", 4)
+check((s.name, s.sides, s.size), ("square", 4, 1.0))
+s = Shape("square", 4, 3.0)
+check(s.size, 3.0)
+s = Shape(name="tri", sides=3, size=2.0)
+check((s.name, s.sides, s.size), ("tri", 3, 2.0))
+s = Shape("tri", size=5.0, sides=3)
+check((s.name, s.sides, s.size), ("tri", 3, 5.0))
+check_raises(TypeError, Shape, "tri", 3, 1.0, 4)
+check_raises(TypeError, Shape, 1)
+check_raises(TypeError, Shape, "tri", bogus=1)
+
+# overloaded methods
+s = Shape(sides=3)
+check(s.kind(1), "int")
+check(s.kind(1.5), "double")
+check(s.kind("a"), "string")
+check(s.kind(1, 2), "int,int")
+check_raises(TypeError, s.kind)
+check_raises(TypeError, s.kind, 1, 2, 3)
+
+# keyword arguments and defaults
+s = Shape("sq", 4, 1.0)
+check(s.scale(), 2.0)
+check(s.scale(3), 6.0)
+check(s.scale(1, 1), 7.0)
+check(s.scale(offset=1), 15.0)
+check(s.scale(factor=1, offset=-5), 10.0)
+check(s.scale(offset=0, factor=0.5), 5.0)
+check_raises(TypeError, s.scale, bogus=1)
+check_raises(TypeError, s.scale, 1, factor=1)
+check_raises(TypeError, s.scale, 1, 2, 3)
+
+# defaults without keyword arguments
+check(s.corners(), 4)
+check(s.corners(2), 6)
+check(Shape.count(1), 111)
+check(Shape.count(1, 2), 103)
+check(Shape.count(1, 2, 3), 6)
+check_raises(TypeError, Shape.count)
+
+# free functions
+check(area(Shape("sq", 4, 2.0)), 4.0)
+check(area(Shape("sq", 4, 2.0), 0.5), 2.0)
+check(area(factor=2, shape=Shape("sq", 4, 3.0)), 18.0)
+check(describe(Shape()), "shape")
+check(describe(1), "int")
+check_raises(TypeError, describe, "x")
+
+# a Python subclass of the wrapped type
+class Hexagon(Shape):
+    def __init__(self, size=1.0):
+        super().__init__("hexagon", 6, size)
+        self.label = "hex"
+
+    def corners(self, extra=0):
+        return Shape.corners(self, extra) * 10
+
+h = Hexagon(2.0)
+check((h.name, h.sides, h.size, h.label), ("hexagon", 6, 2.0, "hex"))
+check(h.corners(), 60)
+check(h.corners(1), 70)
+check(h.kind(1.5), "double")
+check(h.scale(offset=1), 5.0)
+check(area(h), 25.0)
+check(describe(h), "shape")
+check(isinstance(h, Shape), True)
+
+class Plain(Shape):
+    pass
+
+p = Plain()
+check((p.name, p.sides), ("polygon", 0))
+p = Plain(name="pent", sides=5)
+check((p.name, p.sides, p.size), ("pent", 5, 1.0))
+check(p.corners(1), 6)
+check(p.scale(factor=3), 3.0)
+
+class Origin(Point):
+    def __init__(self):
+        super().__init__(0, 0)
+
+check(Origin().x, 0)
@@ -0,0 +1,37 @@
+from python_nothisslot import *
+
+f = Foo(2)
+if use(f) != 2:
+    raise RuntimeError("use(f) failed")
+
+if not is_python_builtin():
+    if "SwigPyProxy" in [c.__name__ for c in type(f).__mro__]:
+        raise RuntimeError("Foo derives from SwigPyProxy")
+
+    # proxies can be combined with built-in types having their own layout
+    class Error(Foo, Exception):
+        pass
+
+    class Dict(Foo, dict):
+        pass
+
+    class Int(Foo, int):
+        pass
+
+    e = Error(7)
+    if use(e) != 7:
+        raise RuntimeError("use(Error) failed")
+    d = Dict(8)
+    if use(d) != 8:
+        raise RuntimeError("use(Dict) failed")
+
+    class Delegate(Foo):
+        def __init__(self, inner):
+            self.inner = inner
+
+        @property
+        def this(self):
+            return self.inner.this
+
+    if use(Delegate(Foo(4))) != 4:
+        raise RuntimeError("use(Delegate) failed")
@@ -2,6 +2,7 @@
 #  python python_pybuffer_runme.py benchmark
 # for the benchmark, other wise the test case will be run
 import python_pybuffer
+import array
 import sys
 
 def check(flag):
@@ -68,3 +69,81 @@ else:
         raise RuntimeError("should throw TypeError")
     except TypeError as e:
         check("(const char *buf4)" in str(e))
+
+    # typed arrays
+    check(python_pybuffer.sum_array(array.array("d", [1, 2, 3])) == 6)
+    try:
+        python_pybuffer.sum_array(array.array("f", [1, 2, 3]))
+        raise RuntimeError("should throw TypeError")
+    except TypeError as e:
+        check("(const double *values, size_t count)" in str(e))
+
+    ints = array.array("i", [1, 2, 3])
+    python_pybuffer.double_array(ints)
+    check(ints.tolist() == [2, 4, 6])
+    try:
+        python_pybuffer.double_array(b"abcd")
+        raise RuntimeError("should throw TypeError")
+    except TypeError as e:
+        check("(int *values, int count)" in str(e))
+
+    # views of C arrays keep their owner alive
+    s = python_pybuffer.Samples()
+    view = s.samples
+    check(view.format == "h" and view.tolist() == [0, 1, 2, 3])
+    view[1] = 10
+    check(s.samples[1] == 10)
+    del s
+    check(view.tolist() == [0, 10, 2, 3])
+
+    # std::vector of an arithmetic type converted from and viewed as a buffer
+    check(python_pybuffer.sum_vector(array.array("d", [1, 2, 3])) == 6)
+    check(python_pybuffer.sum_vector(array.array("i", [1, 2, 3])) == 6)
+    check(python_pybuffer.sum_vector(python_pybuffer.DoubleVector([1, 2, 3])) == 6)
+    try:
+        python_pybuffer.sum_vector(memoryview(array.array("d", [1, 2, 3, 4])).cast("B").cast("d", [2, 2]))
+        raise RuntimeError("should throw TypeError")
+    except TypeError:
+        pass
+
+    def view_of(v):
+        if python_pybuffer.is_python_builtin() or sys.version_info >= (3, 12):
+            return memoryview(v)
+        return v.__buffer__(0)
+
+    v = python_pybuffer.DoubleVector([1, 2, 3])
+    view = view_of(v)
+    check(view.format == "d" and view.tolist() == [1, 2, 3])
+    view[0] = 5
+    check(v[0] == 5)
+    v[1] = 6
+    check(view[1] == 6)
+
+    # ... which can't be resized while the view is in use
+    for resize in (lambda: v.push_back(4), lambda: v.append(4), lambda: v.pop(), lambda: v.resize(100000),
+                   lambda: v.reserve(100000), lambda: v.clear(), lambda: v.__setitem__(slice(0, 1), python_pybuffer.DoubleVector()),
+                   lambda: v.__delitem__(0), lambda: v.__delitem__(slice(0, 1))):
+        try:
+            resize()
+            raise RuntimeError("should throw BufferError")
+        except BufferError:
+            pass
+    check(len(v) == 3)
+
+    # the view keeps the vector alive
+    del v
+    check(view.tolist() == [5, 6, 3])
+    v = python_pybuffer.DoubleVector([1, 2, 3])
+    view = view_of(v)
+    view.release()
+    v.push_back(4)
+    check(len(v) == 4)
+
+    # vectors of other types are not buffers
+    if python_pybuffer.is_python_builtin() or sys.version_info >= (3, 12):
+        try:
+            memoryview(python_pybuffer.BoolVector([True]))
+            raise RuntimeError("should throw TypeError")
+        except TypeError:
+            pass
+    check(bytes(python_pybuffer.UCharVector([1, 2, 3])) == b"\x01\x02\x03")
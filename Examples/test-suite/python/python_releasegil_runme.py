@@ -0,0 +1,33 @@
+from python_releasegil import *
+
+
+class Square(Callback):
+
+    def __init__(self):
+        Callback.__init__(self)
+        self.calls = 0
+
+    def run(self, i):
+        self.calls += 1
+        return i * i
+
+
+w = Worker()
+
+if w.compute():
+    raise RuntimeError("compute() did not release the GIL")
+if not w.hold():
+    raise RuntimeError("hold() released the GIL")
+
+for max_upcalls in (0, 1, 7, 100):
+    s = Square()
+    total = w.batch(s, 50, max_upcalls)
+    if total != sum(i * i for i in range(50)):
+        raise RuntimeError("batch({}) returned {}".format(max_upcalls, total))
+    if s.calls != 50:
+        raise RuntimeError("batch({}) made {} upcalls".format(max_upcalls, s.calls))
+
+s = Square()
+total = w.unordered(s, 10)
+if total != sum(i * i for i in range(10)):
+    raise RuntimeError("unordered() returned {}".format(total))
@@ -0,0 +1,46 @@
+from python_thisslot import *
+
+f = Foo(2)
+if use(f) != 2:
+    raise RuntimeError("use(f) failed")
+
+if not is_python_builtin():
+    if "SwigPyProxy" not in [c.__name__ for c in type(f).__mro__]:
+        raise RuntimeError("Foo does not derive from SwigPyProxy")
+
+    # instances still have a dictionary
+    f.extra = 3
+    if f.extra != 3:
+        raise RuntimeError("f.extra failed")
+
+    # a subclass may redefine this as a property
+    class Delegate(Foo):
+        def __init__(self, inner):
+            self.inner = inner
+
+        @property
+        def this(self):
+            return self.inner.this
+
+    if use(Delegate(Foo(4))) != 4:
+        raise RuntimeError("use(Delegate) failed")
+
+    # ... even after instances were converted through the slot
+    class Sub(Foo):
+        pass
+
+    s = Sub(5)
+    if use(s) != 5:
+        raise RuntimeError("use(Sub) failed")
+    other = Foo(6)
+    Sub.this = property(lambda self: other.this)
+    if use(s) != 6:
+        raise RuntimeError("use(Sub) after redefining this failed")
+
+    # the slot gives proxies an instance layout which built-in types with a layout can't share
+    try:
+        class Error(Foo, Exception):
+            pass
+        raise RuntimeError("Foo and Exception bases not rejected")
+    except TypeError:
+        pass
@@ -0,0 +1,41 @@
+%module python_fastcall
+
+// Built with -fastcall, wrappers take their arguments as a C array
+%feature("kwargs") Shape::scale;
+%feature("kwargs") Shape::Shape;
+%feature("kwargs") area;
+
+%include <std_string.i>
+
+%inline %{
+#include <string>
+
+struct Shape {
+  std::string name;
+  int sides;
+  double size;
+  Shape(const char *name = "polygon", int sides = 0, double size = 1) : name(name), sides(sides), size(size) {}
+  virtual ~Shape() {}
+
+  const char *kind(int) const { return "int"; }
+  const char *kind(double) const { return "double"; }
+  const char *kind(const char *) const { return "string"; }
+  const char *kind(int, int) const { return "int,int"; }
+
+  double scale(double factor = 2, double offset = 0) { size = size * factor + offset; return size; }
+  int corners(int extra = 0) const { return sides + extra; }
+  static int count(int a, int b = 10, int c = 100) { return a + b + c; }
+};
+
+struct Point {
+  int x, y;
+  Point() : x(0), y(0) {}
+  Point(int x) : x(x), y(x) {}
+  Point(int x, int y) : x(x), y(y) {}
+  Point(const Point &other) : x(other.x), y(other.y) {}
+};
+
+double area(const Shape &shape, double factor = 1) { return shape.size * shape.size * factor; }
+const char *describe(const Shape &) { return "shape"; }
+const char *describe(int) { return "int"; }
+%}
@@ -0,0 +1,18 @@
+%module python_nothisslot
+
+// Built with -nothisslot, see python_thisslot.i for the slot
+%inline %{
+struct Foo {
+  int x;
+  Foo(int x = 1) : x(x) {}
+  int get() const { return x; }
+};
+
+int use(const Foo *f) { return f->get(); }
+
+#ifdef SWIGPYTHON_BUILTIN
+bool is_python_builtin() { return true; }
+#else
+bool is_python_builtin() { return false; }
+#endif
+%}
@@ -62,3 +62,42 @@ void title2(char *str2) {
     title(str2);
 }
 %}
+
+/*typed arrays and views sharing the memory of Python buffers*/
+%include <std_vector.i>
+%template(DoubleVector) std::vector<double>;
+%template(UCharVector) std::vector<unsigned char>;
+%template(BoolVector) std::vector<bool>;
+
+%pybuffer_array(const double *values, size_t count);
+%pybuffer_mutable_array(int *values, int count);
+%pybuffer_view(short samples[ANY]);
+
+%inline %{
+#ifdef SWIGPYTHON_BUILTIN
+bool is_python_builtin() { return true; }
+#else
+bool is_python_builtin() { return false; }
+#endif
+
+double sum_array(const double *values, size_t count) {
+  double sum = 0;
+  for (size_t i = 0; i < count; ++i)
+    sum += values[i];
+  return sum;
+}
+void double_array(int *values, int count) {
+  for (int i = 0; i < count; ++i)
+    values[i] *= 2;
+}
+double sum_vector(const std::vector<double> &values) {
+  return sum_array(values.empty() ? 0 : &values[0], values.size());
+}
+struct Samples {
+  short samples[4];
+  Samples() {
+    for (int i = 0; i < 4; ++i)
+      samples[i] = (short)i;
+  }
+};
+%}
@@ -0,0 +1,46 @@
+%module(directors="1") python_releasegil
+
+// Thread support is only enabled by %pythonreleasegil, not by -threads
+%pythonreleasegil Worker::compute;
+%pythonreleasegil Worker::batch;
+%nothreadallow Worker::hold;
+%nothreadallow Worker::unordered;
+
+%feature("director") Callback;
+
+%inline %{
+struct Callback {
+  virtual ~Callback() {}
+  virtual int run(int i) = 0;
+};
+
+struct Worker {
+  // Whether the calling thread holds the GIL
+  bool compute() {
+    return PyGILState_Check() != 0;
+  }
+  bool hold() {
+    return PyGILState_Check() != 0;
+  }
+  // Upcalls from a thread without the GIL, which is held by batches of max_upcalls
+  int batch(Callback *callback, int n, unsigned long max_upcalls) {
+    int sum = 0;
+    Swig::DirectorGILBatch gil(max_upcalls);
+    for (int i = 0; i < n; i++)
+      sum += callback->run(i);
+    gil.end();
+    return sum;
+  }
+  // Batches which don't end in the reverse order they started in, with the GIL held
+  int unordered(Callback *callback, int n) {
+    int sum = 0;
+    Swig::DirectorGILBatch *outer = new Swig::DirectorGILBatch(1);
+    Swig::DirectorGILBatch *inner = new Swig::DirectorGILBatch(1);
+    delete outer;
+    for (int i = 0; i < n; i++)
+      sum += callback->run(i);
+    delete inner;
+    return Swig::DirectorGILBatch::current() ? -1 : sum;
+  }
+};
+%}
@@ -0,0 +1,18 @@
+%module python_thisslot
+
+// Built with -thisslot, see python_nothisslot.i for the default
+%inline %{
+struct Foo {
+  int x;
+  Foo(int x = 1) : x(x) {}
+  int get() const { return x; }
+};
+
+int use(const Foo *f) { return f->get(); }
+
+#ifdef SWIGPYTHON_BUILTIN
+bool is_python_builtin() { return true; }
+#else
+bool is_python_builtin() { return false; }
+#endif
+%}
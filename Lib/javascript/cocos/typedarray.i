@@ -0,0 +1,190 @@
+/* -----------------------------------------------------------------------------
+ * typedarray.i
+ *
+ * Typemaps passing std::vector of arithmetic types and C arrays to and from
+ * JavaScript typed arrays in one block copy, or without any copy, instead of
+ * converting the elements one se::Value at a time.
+ *
+ * Input:
+ *   - std::vector<T> and const std::vector<T>& are filled from a typed array
+ *     of the matching element type with a single copy. Other values, such as
+ *     plain arrays, take the element-wise conversion.
+ *   - (const T *DATA, size_t LENGTH) borrows the backing store of a typed array
+ *     of the matching element type for the duration of the call.
+ *
+ * Output, a std::vector<T> or std::vector<T>& result is returned as a typed
+ * array. By default the elements are copied. %feature("js:typedarray") on the
+ * function selects the storage instead:
+ *   - "adopt": a std::vector<T> returned by value is moved into the
+ *              ArrayBuffer, which frees it when it is collected.
+ *   - "wrap":  a std::vector<T>& result is exposed as is. The vector must
+ *              outlive the typed array and must not be resized meanwhile.
+ *              A const std::vector<T>& result is still copied, as script
+ *              code could write to its elements through the typed array.
+ *
+ * Example usage:
+ *
+ *   %include <typedarray.i>
+ *   %feature("js:typedarray", "adopt") Mesh::buildVertices;
+ *   %feature("js:typedarray", "wrap") Mesh::getIndices;
+ *   %apply (const float *DATA, size_t LENGTH) { (const float *data, size_t count) };
+ *
+ * 64-bit integer types have no matching typed array here and always use the
+ * element-wise conversion.
+ * ----------------------------------------------------------------------------- */
+
+%fragment("js_typedarray", "header") %{
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename T>
+se::Object::TypedArrayType js_typedarray_type() {
+    if (std::is_floating_point<T>::value) {
+        return sizeof(T) == 4 ? se::Object::TypedArrayType::FLOAT32 : se::Object::TypedArrayType::FLOAT64;
+    }
+    switch (sizeof(T)) {
+        case 1: return std::is_signed<T>::value ? se::Object::TypedArrayType::INT8 : se::Object::TypedArrayType::UINT8;
+        case 2: return std::is_signed<T>::value ? se::Object::TypedArrayType::INT16 : se::Object::TypedArrayType::UINT16;
+        case 4: return std::is_signed<T>::value ? se::Object::TypedArrayType::INT32 : se::Object::TypedArrayType::UINT32;
+        default: return se::Object::TypedArrayType::NONE;
+    }
+}
+
+// Points data at the elements of a typed array of element type T, without copying.
+template <typename T>
+bool js_typedarray_borrow(const se::Value &from, T **data, size_t *count) {
+    se::Object::TypedArrayType type = js_typedarray_type<T>();
+    if (type == se::Object::TypedArrayType::NONE || !from.isObject()) {
+        return false;
+    }
+    se::Object *obj = from.toObject();
+    if (!obj->isTypedArray() || obj->getTypedArrayType() != type) {
+        return false;
+    }
+    uint8_t *bytes = nullptr;
+    size_t length = 0;
+    if (!obj->getTypedArrayData(&bytes, &length)) {
+        return false;
+    }
+    *data = reinterpret_cast<T *>(bytes);
+    *count = length / sizeof(T);
+    return true;
+}
+
+template <typename T>
+bool js_typedarray_to_vector(const se::Value &from, std::vector<T> *to, se::Object *ctx) {
+    T *data = nullptr;
+    size_t count = 0;
+    if (js_typedarray_borrow(from, &data, &count)) {
+        to->assign(data, data + count);
+        return true;
+    }
+    return sevalue_to_native(from, to, ctx);
+}
+
+template <typename T>
+bool js_vector_to_typedarray(const std::vector<T> &from, se::Value &to, se::Object *ctx) {
+    se::Object::TypedArrayType type = js_typedarray_type<T>();
+    if (type == se::Object::TypedArrayType::NONE) {
+        return nativevalue_to_se(from, to, ctx);
+    }
+    se::HandleObject array(se::Object::createTypedArray(type, from.data(), from.size() * sizeof(T)));
+    to.setObject(array.get());
+    return true;
+}
+
+// Exposes the storage of from without copying. Frees it with freeFunc, unless null.
+template <typename T>
+bool js_vector_wrap_typedarray(std::vector<T> &from, se::Value &to, se::Object *ctx, se::Object::BufferContentsFreeFunc freeFunc, void *freeUserData) {
+    se::Object::TypedArrayType type = js_typedarray_type<T>();
+    size_t byteLength = from.size() * sizeof(T);
+    if (type == se::Object::TypedArrayType::NONE || byteLength == 0) {
+        bool ok = js_vector_to_typedarray(from, to, ctx);
+        if (freeFunc) {
+            freeFunc(from.data(), byteLength, freeUserData);
+        }
+        return ok;
+    }
+    se::HandleObject buffer(se::Object::createExternalArrayBufferObject(from.data(), byteLength, freeFunc, freeUserData));
+    se::HandleObject array(se::Object::createTypedArrayWithBuffer(type, buffer.get(), 0, byteLength));
+    to.setObject(array.get());
+    return true;
+}
+
+template <typename T>
+bool js_vector_adopt_typedarray(std::vector<T> &&from, se::Value &to, se::Object *ctx) {
+    auto *storage = new std::vector<T>(std::move(from));
+    return js_vector_wrap_typedarray(*storage, to, ctx, [](void *, size_t, void *userData) {
+        delete static_cast<std::vector<T> *>(userData);
+    }, storage);
+}
+%}
+
+%define %typedarray_vector(TYPE)
+
+%typemap(in, fragment="js_typedarray") std::vector<TYPE>
+%{
+  ok &= js_typedarray_to_vector($input, &$1, s.thisObject());
+  SWIG_JS_CHECK_ARG(ok, $jsargindex); %}
+
+%typemap(in, fragment="js_typedarray") const std::vector<TYPE> & ($*ltype temp)
+%{
+  ok &= js_typedarray_to_vector($input, &temp, s.thisObject());
+  SWIG_JS_CHECK_ARG(ok, $jsargindex);
+  $1 = &temp;
+%}
+
+%typemap(out, fragment="js_typedarray") std::vector<TYPE>
+%{
+  ok &= js_vector_to_typedarray($1, s.rval(), s.thisObject());
+  SWIG_JS_CHECK_RESULT(ok); %}
+
+%typemap(out, fragment="js_typedarray") std::vector<TYPE> &, const std::vector<TYPE> &
+%{
+  ok &= js_vector_to_typedarray(*$1, s.rval(), s.thisObject());
+  SWIG_JS_CHECK_RESULT(ok); %}
+
+%typemap(out_adopt, fragment="js_typedarray") std::vector<TYPE>
+%{
+  ok &= js_vector_adopt_typedarray(std::move($1), s.rval(), s.thisObject());
+  SWIG_JS_CHECK_RESULT(ok); %}
+
+%typemap(out_wrap, fragment="js_typedarray") std::vector<TYPE> &
+%{
+  ok &= js_vector_wrap_typedarray(*$1, s.rval(), s.thisObject(), nullptr, nullptr);
+  SWIG_JS_CHECK_RESULT(ok); %}
+
+// a const vector is copied, script code could otherwise write to it through the typed array
+%typemap(out_wrap, fragment="js_typedarray") const std::vector<TYPE> &
+%{
+  ok &= js_vector_to_typedarray(*$1, s.rval(), s.thisObject());
+  SWIG_JS_CHECK_RESULT(ok); %}
+
+%typemap(in, fragment="js_typedarray") (const TYPE *DATA, size_t LENGTH), (TYPE *DATA, size_t LENGTH)
+%{
+  ok &= js_typedarray_borrow($input, const_cast<TYPE **>(&$1), &$2);
+  SWIG_JS_CHECK_ARG(ok, $jsargindex); %}
+
+%typecheck(SWIG_TYPECHECK_VECTOR) std::vector<TYPE>, const std::vector<TYPE> &
+  "$1 = $input.isObject();"
+
+%typecheck(SWIG_TYPECHECK_POINTER) (const TYPE *DATA, size_t LENGTH), (TYPE *DATA, size_t LENGTH)
+  "$1 = $input.isObject() && $input.toObject()->isTypedArray();"
+
+%enddef
+
+%typedarray_vector(signed char)
+%typedarray_vector(unsigned char)
+%typedarray_vector(short)
+%typedarray_vector(unsigned short)
+%typedarray_vector(int)
+%typedarray_vector(unsigned int)
+%typedarray_vector(float)
+%typedarray_vector(double)
+%typedarray_vector(int8_t)
+%typedarray_vector(uint8_t)
+%typedarray_vector(int16_t)
+%typedarray_vector(uint16_t)
+%typedarray_vector(int32_t)
+%typedarray_vector(uint32_t)
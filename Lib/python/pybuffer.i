@@ -1,5 +1,261 @@
 /* Implementing buffer protocol typemaps */
 
+/* -----------------------------------------------------------------------------
+ * Buffer fragments shared with std_vector.i
+ * ----------------------------------------------------------------------------- */
+
+/* SWIG_PYBUFFER_KIND(TYPE) classifies an arithmetic C type like the struct
+ * module formats do: 'f' floating point, 'i' signed and 'u' unsigned integer. */
+
+%fragment("SWIG_Python_BufferFormat", "header", fragment="SWIG_LongLongAvailable") {
+%#define SWIG_PYBUFFER_KIND(TYPE) ((TYPE)0.5 > (TYPE)0 ? 'f' : (TYPE)-1 < (TYPE)0 ? 'i' : 'u')
+
+/* The native struct module format of items of the given kind and size, 0 if there is none */
+SWIGINTERN const char *
+SWIG_Python_BufferFormat(char kind, size_t itemsize) {
+  switch (kind) {
+  case 'f':
+    return itemsize == sizeof(float) ? "f" : itemsize == sizeof(double) ? "d" : 0;
+  case 'i':
+    return itemsize == 1 ? "b" : itemsize == sizeof(short) ? "h" : itemsize == sizeof(int) ? "i" : itemsize == sizeof(long) ? "l" :
+%#ifdef SWIG_LONG_LONG_AVAILABLE
+      itemsize == sizeof(long long) ? "q" :
+%#endif
+      0;
+  case 'u':
+    return itemsize == 1 ? "B" : itemsize == sizeof(unsigned short) ? "H" : itemsize == sizeof(unsigned int) ? "I" : itemsize == sizeof(unsigned long) ? "L" :
+%#ifdef SWIG_LONG_LONG_AVAILABLE
+      itemsize == sizeof(unsigned long long) ? "Q" :
+%#endif
+      0;
+  }
+  return 0;
+}
+
+/* The kind of the items of a buffer format, 0 unless it is a single arithmetic item in native byte order */
+SWIGINTERN char
+SWIG_Python_BufferKind(const char *format) {
+  static const int one = 1;
+  const int little = *(const char *)&one;
+  char kind = 0;
+  if (!format)
+    format = "B";
+  if (*format == '@' || *format == '=' || (*format == '<' && little) || ((*format == '>' || *format == '!') && !little))
+    ++format;
+  switch (*format) {
+  case 'e': case 'f': case 'd':
+    kind = 'f';
+    break;
+  case 'b': case 'h': case 'i': case 'l': case 'q': case 'n':
+    kind = 'i';
+    break;
+  case 'B': case 'H': case 'I': case 'L': case 'Q': case 'N': case '?':
+    kind = 'u';
+    break;
+  }
+  return format[1] ? 0 : kind;
+}
+
+/* Get a C contiguous buffer of items of the given kind and size, such as a NumPy array or
+   an array.array, without copying it. On failure no Python error is set and there is no
+   buffer to release. */
+SWIGINTERN int
+SWIG_Python_GetArrayBuffer(PyObject *obj, Py_buffer *view, char kind, size_t itemsize, int writable) {
+  if (!PyObject_CheckBuffer(obj))
+    return SWIG_TypeError;
+  if (PyObject_GetBuffer(obj, view, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS | (writable ? PyBUF_WRITABLE : 0)) < 0) {
+    PyErr_Clear();
+    return SWIG_TypeError;
+  }
+  if ((size_t)view->itemsize != itemsize || SWIG_Python_BufferKind(view->format) != kind) {
+    PyBuffer_Release(view);
+    return SWIG_TypeError;
+  }
+  return SWIG_OK;
+}
+}
+
+/* SWIG_Python_NewBufferView returns a memoryview of count items at buf. The memory
+ * is not copied, it belongs to owner which the view keeps alive.
+ * SWIG_Python_NewBufferExport also calls release(data) once the memoryview and all the
+ * buffers taken from it are released, so that owner can count its live exports. */
+
+%fragment("SwigPyBuffer", "header", fragment="SWIG_Python_BufferFormat") {
+typedef struct {
+  PyObject_HEAD
+  PyObject *owner;
+  void *buf;
+  Py_ssize_t shape[1];
+  Py_ssize_t strides[1];
+  const char *format;
+  int readonly;
+  void (*release)(void *);
+  void *data;
+} SwigPyBuffer;
+
+SWIGINTERN int
+SwigPyBuffer_getbuffer(PyObject *obj, Py_buffer *view, int flags) {
+  SwigPyBuffer *self = (SwigPyBuffer *)obj;
+  if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE && self->readonly) {
+    PyErr_SetString(PyExc_BufferError, "buffer is not writable");
+    view->obj = NULL;
+    return -1;
+  }
+  Py_INCREF(obj);
+  view->obj = obj;
+  view->buf = self->buf;
+  view->len = self->shape[0] * self->strides[0];
+  view->itemsize = self->strides[0];
+  view->readonly = self->readonly;
+  view->ndim = 1;
+  view->format = (flags & PyBUF_FORMAT) ? (char *)self->format : NULL;
+  view->shape = (flags & PyBUF_ND) == PyBUF_ND ? self->shape : NULL;
+  view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? self->strides : NULL;
+  view->suboffsets = NULL;
+  view->internal = NULL;
+  return 0;
+}
+
+SWIGINTERN void
+SwigPyBuffer_dealloc(PyObject *obj) {
+  SwigPyBuffer *self = (SwigPyBuffer *)obj;
+  if (self->release)
+    self->release(self->data);
+  Py_XDECREF(self->owner);
+  PyObject_DEL(obj);
+}
+
+SWIGINTERN PyTypeObject *
+SwigPyBuffer_TypeOnce(void) {
+  static char swigpybuffer_doc[] = "Swig object exporting the memory of a C/C++ array";
+  static PyBufferProcs swigpybuffer_as_buffer;
+  static PyTypeObject swigpybuffer_type;
+  static int type_init = 0;
+  if (!type_init) {
+    const PyTypeObject tmp = {
+%#if PY_VERSION_HEX>=0x03000000
+      PyVarObject_HEAD_INIT(NULL, 0)
+%#else
+      PyObject_HEAD_INIT(NULL)
+      0,                                    /* ob_size */
+%#endif
+      "SwigPyBuffer",                       /* tp_name */
+      sizeof(SwigPyBuffer),                 /* tp_basicsize */
+      0,                                    /* tp_itemsize */
+      SwigPyBuffer_dealloc,                 /* tp_dealloc */
+%#if PY_VERSION_HEX < 0x030800b4
+      (printfunc)0,                         /* tp_print */
+%#else
+      (Py_ssize_t)0,                        /* tp_vectorcall_offset */
+%#endif
+      (getattrfunc)0,                       /* tp_getattr */
+      (setattrfunc)0,                       /* tp_setattr */
+      0,                                    /* tp_compare or tp_reserved */
+      (reprfunc)0,                          /* tp_repr */
+      0,                                    /* tp_as_number */
+      0,                                    /* tp_as_sequence */
+      0,                                    /* tp_as_mapping */
+      (hashfunc)0,                          /* tp_hash */
+      (ternaryfunc)0,                       /* tp_call */
+      (reprfunc)0,                          /* tp_str */
+      PyObject_GenericGetAttr,              /* tp_getattro */
+      0,                                    /* tp_setattro */
+      &swigpybuffer_as_buffer,              /* tp_as_buffer */
+%#if PY_VERSION_HEX>=0x03000000
+      Py_TPFLAGS_DEFAULT,                   /* tp_flags */
+%#else
+      Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER, /* tp_flags */
+%#endif
+      swigpybuffer_doc,                     /* tp_doc */
+      0,                                    /* tp_traverse */
+      0,                                    /* tp_clear */
+      0,                                    /* tp_richcompare */
+      0,                                    /* tp_weaklistoffset */
+      0,                                    /* tp_iter */
+      0,                                    /* tp_iternext */
+      0,                                    /* tp_methods */
+      0,                                    /* tp_members */
+      0,                                    /* tp_getset */
+      0,                                    /* tp_base */
+      0,                                    /* tp_dict */
+      0,                                    /* tp_descr_get */
+      0,                                    /* tp_descr_set */
+      0,                                    /* tp_dictoffset */
+      0,                                    /* tp_init */
+      0,                                    /* tp_alloc */
+      0,                                    /* tp_new */
+      0,                                    /* tp_free */
+      0,                                    /* tp_is_gc */
+      0,                                    /* tp_bases */
+      0,                                    /* tp_mro */
+      0,                                    /* tp_cache */
+      0,                                    /* tp_subclasses */
+      0,                                    /* tp_weaklist */
+      0,                                    /* tp_del */
+      0,                                    /* tp_version_tag */
+%#if PY_VERSION_HEX >= 0x03040000
+      0,                                    /* tp_finalize */
+%#endif
+%#if PY_VERSION_HEX >= 0x03080000
+      0,                                    /* tp_vectorcall */
+%#endif
+%#if (PY_VERSION_HEX >= 0x03080000) && (PY_VERSION_HEX < 0x03090000)
+      0,                                    /* tp_print */
+%#endif
+%#ifdef COUNT_ALLOCS
+      0,                                    /* tp_allocs */
+      0,                                    /* tp_frees */
+      0,                                    /* tp_maxalloc */
+      0,                                    /* tp_prev */
+      0                                     /* tp_next */
+%#endif
+    };
+    swigpybuffer_as_buffer.bf_getbuffer = SwigPyBuffer_getbuffer;
+    swigpybuffer_type = tmp;
+    type_init = 1;
+    if (PyType_Ready(&swigpybuffer_type) != 0)
+      return NULL;
+  }
+  return &swigpybuffer_type;
+}
+
+SWIGINTERN PyObject *
+SWIG_Python_NewBufferExport(PyObject *owner, void *buf, size_t count, size_t itemsize, const char *format, int readonly,
+                            void (*release)(void *), void *data) {
+  static char empty;
+  PyTypeObject *type = SwigPyBuffer_TypeOnce();
+  SwigPyBuffer *self = NULL;
+  PyObject *view;
+  if (type && !format)
+    PyErr_SetString(PyExc_BufferError, "items of this type can't be viewed as a buffer");
+  else if (type)
+    self = PyObject_NEW(SwigPyBuffer, type);
+  if (!self) {
+    if (release)
+      release(data);
+    return NULL;
+  }
+  self->release = release;
+  self->data = data;
+  Py_XINCREF(owner);
+  self->owner = owner;
+  self->buf = buf ? buf : &empty;
+  self->shape[0] = (Py_ssize_t)count;
+  self->strides[0] = (Py_ssize_t)itemsize;
+  self->format = format;
+  self->readonly = readonly;
+  view = PyMemoryView_FromObject((PyObject *)self);
+  Py_DECREF(self);
+  return view;
+}
+
+SWIGINTERN PyObject *
+SWIG_Python_NewBufferView(PyObject *owner, void *buf, size_t count, size_t itemsize, const char *format, int readonly) {
+  return SWIG_Python_NewBufferExport(owner, buf, count, itemsize, format, readonly, 0, 0);
+}
+}
+
+
 /* %pybuffer_mutable_binary(TYPEMAP, SIZE)
  *
  * Macro for functions accept mutable buffer pointer with a size.
@@ -117,3 +373,98 @@
   $1 = ($1_ltype) buf;
 }
 %enddef
+
+/* %pybuffer_array(TYPEMAP, SIZE)
+ *
+ * Macro for functions accepting a read only array of an arithmetic type with
+ * its number of items. Any C contiguous buffer with items of a matching type
+ * and size, such as a NumPy array or an array.array, is passed without a copy.
+ * For example:
+ *
+ *      %pybuffer_array(const double *values, size_t count);
+ *      double sum(const double *values, size_t count) {
+ *        double s = 0;
+ *        for (size_t i = 0; i < count; ++i)
+ *          s += values[i];
+ *        return s;
+ *      }
+ */
+
+%define %pybuffer_array(TYPEMAP, SIZE)
+%typemap(in, fragment="SWIG_Python_BufferFormat") (TYPEMAP, SIZE) (Py_buffer view) {
+  int res;
+  view.obj = NULL;
+  res = SWIG_Python_GetArrayBuffer($input, &view, SWIG_PYBUFFER_KIND($*1_ltype), sizeof($*1_ltype), 0);
+  if (!SWIG_IsOK(res)) {
+    %argument_fail(res, "(TYPEMAP, SIZE)", $symname, $argnum);
+  }
+  $1 = ($1_ltype) view.buf;
+  $2 = ($2_ltype) (view.len / view.itemsize);
+}
+%typemap(typecheck, precedence=SWIG_TYPECHECK_POINTER, fragment="SWIG_Python_BufferFormat") (TYPEMAP, SIZE) {
+  Py_buffer view;
+  $1 = SWIG_IsOK(SWIG_Python_GetArrayBuffer($input, &view, SWIG_PYBUFFER_KIND($*1_ltype), sizeof($*1_ltype), 0));
+  if ($1)
+    PyBuffer_Release(&view);
+}
+%typemap(freearg) (TYPEMAP, SIZE) {
+  if (view$argnum.obj)
+    PyBuffer_Release(&view$argnum);
+}
+%enddef
+
+/* %pybuffer_mutable_array(TYPEMAP, SIZE)
+ *
+ * Macro for functions accepting a writable array of an arithmetic type with
+ * its number of items, the changes are made in the memory of the Python
+ * object. For example:
+ *
+ *      %pybuffer_mutable_array(float *values, int count);
+ *      void scale(float *values, int count, float factor) {
+ *        for (int i = 0; i < count; ++i)
+ *          values[i] *= factor;
+ *      }
+ */
+
+%define %pybuffer_mutable_array(TYPEMAP, SIZE)
+%typemap(in, fragment="SWIG_Python_BufferFormat") (TYPEMAP, SIZE) (Py_buffer view) {
+  int res;
+  view.obj = NULL;
+  res = SWIG_Python_GetArrayBuffer($input, &view, SWIG_PYBUFFER_KIND($*1_ltype), sizeof($*1_ltype), 1);
+  if (!SWIG_IsOK(res)) {
+    %argument_fail(res, "(TYPEMAP, SIZE)", $symname, $argnum);
+  }
+  $1 = ($1_ltype) view.buf;
+  $2 = ($2_ltype) (view.len / view.itemsize);
+}
+%typemap(typecheck, precedence=SWIG_TYPECHECK_POINTER, fragment="SWIG_Python_BufferFormat") (TYPEMAP, SIZE) {
+  Py_buffer view;
+  $1 = SWIG_IsOK(SWIG_Python_GetArrayBuffer($input, &view, SWIG_PYBUFFER_KIND($*1_ltype), sizeof($*1_ltype), 1));
+  if ($1)
+    PyBuffer_Release(&view);
+}
+%typemap(freearg) (TYPEMAP, SIZE) {
+  if (view$argnum.obj)
+    PyBuffer_Release(&view$argnum);
+}
+%enddef
+
+/* %pybuffer_view(TYPEMAP)
+ *
+ * Macro for fixed size arrays of an arithmetic type in a wrapped class, which
+ * are returned as a writable memoryview of the array rather than a pointer.
+ * The memoryview keeps the Python object holding the array alive. For example:
+ *
+ *      %pybuffer_view(double samples[ANY]);
+ *      struct Signal {
+ *        double samples[1024];
+ *      };
+ */
+
+%define %pybuffer_view(TYPEMAP)
+%typemap(out, fragment="SwigPyBuffer") TYPEMAP {
+  $result = SWIG_Python_NewBufferView($self, (void *)$1, $1_dim0, sizeof($1_basetype),
+                                      SWIG_Python_BufferFormat(SWIG_PYBUFFER_KIND($1_basetype), sizeof($1_basetype)), 0);
+  if (!$result) SWIG_fail;
+}
+%enddef
@@ -2,7 +2,7 @@
   Vectors
 */
 
-%fragment("StdVectorTraits","header",fragment="StdSequenceTraits")
+%fragment("StdVectorTraits","header",fragment="StdSequenceTraits",fragment="StdVectorBufferTraits")
 %{
   namespace swig {
     template <class T>
@@ -15,10 +15,11 @@
     template <class T>
     struct traits_asptr<std::vector<T> >  {
       static int asptr(PyObject *obj, std::vector<T> **vec) {
-	return traits_asptr_stdseq<std::vector<T> >::asptr(obj, vec);
+	int res = traits_buffer<T>::asptr(obj, vec);
+	return SWIG_IsOK(res) || res == SWIG_TypeError ? res : traits_asptr_stdseq<std::vector<T> >::asptr(obj, vec);
       }
     };
-    
+
     template <class T>
     struct traits_from<std::vector<T> > {
       static PyObject *from(const std::vector<T>& vec) {
@@ -32,3 +33,16 @@
 #define %swig_vector_methods_val(Type...) %swig_sequence_methods_val(Type);
 
 %include <std/std_vector.i>
+
+%swig_vector_buffer_methods(signed char)
+%swig_vector_buffer_methods(unsigned char)
+%swig_vector_buffer_methods(short)
+%swig_vector_buffer_methods(unsigned short)
+%swig_vector_buffer_methods(int)
+%swig_vector_buffer_methods(unsigned int)
+%swig_vector_buffer_methods(long)
+%swig_vector_buffer_methods(unsigned long)
+%swig_vector_buffer_methods(long long)
+%swig_vector_buffer_methods(unsigned long long)
+%swig_vector_buffer_methods(float)
+%swig_vector_buffer_methods(double)
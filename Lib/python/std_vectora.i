@@ -2,7 +2,7 @@
   Vectors + allocators
 */
 
-%fragment("StdVectorATraits","header",fragment="StdSequenceTraits")
+%fragment("StdVectorATraits","header",fragment="StdSequenceTraits",fragment="StdVectorBufferTraits")
 %{
   namespace swig {
     template <class T, class A>
@@ -10,7 +10,8 @@
       typedef std::vector<T,A> vector_type;
       typedef T value_type;
       static int asptr(PyObject *obj, vector_type **vec) {
-	return traits_asptr_stdseq<vector_type>::asptr(obj, vec);
+	int res = traits_buffer<T>::asptr(obj, vec);
+	return SWIG_IsOK(res) || res == SWIG_TypeError ? res : traits_asptr_stdseq<vector_type>::asptr(obj, vec);
       }
     };
 
@@ -543,21 +543,19 @@ typedef enum { ExactNoMatch = -2, PartiallySpecializedNoMatch = -1, PartiallySpe
  * Template argument deduction - check if a template type matches a partially specialized 
  * template parameter type. Typedef reduce 'partial_parm_type' to see if it matches 'type'.
  *
- * type - template parameter type to match against
+ * ty - typedef reduced template parameter type to match against
+ * base - base type of ty
  * partial_parm_type - partially specialized template type - a possible match
  * partial_parm_type_base - base type of partial_parm_type
- * tscope - template scope
  * specialization_priority - (output) contains a value indicating how good the match is 
  *   (higher is better) only set if return is set to PartiallySpecializedMatch or ExactMatch.
  * ----------------------------------------------------------------------------- */
 
-static EMatch does_parm_match(SwigType *type, SwigType *partial_parm_type, const char *partial_parm_type_base, Symtab *tscope, int *specialization_priority) {
+static EMatch does_parm_match(SwigType *ty, String *base, SwigType *partial_parm_type, const char *partial_parm_type_base, int *specialization_priority) {
   static const int EXACT_MATCH_PRIORITY = 99999; /* a number bigger than the length of any conceivable type */
   int matches;
   int substitutions;
   EMatch match;
-  SwigType *ty = Swig_symbol_typedef_reduce(type, tscope);
-  String *base = SwigType_base(ty);
   SwigType *t = Copy(partial_parm_type);
   substitutions = Replaceid(t, partial_parm_type_base, base); /* eg: Replaceid("p.$1", "$1", "int") returns t="p.int" */
   matches = Equal(ty, t);
@@ -594,11 +592,84 @@ static EMatch does_parm_match(SwigType *type, SwigType *partial_parm_type, const
   Printf(stdout, "      does_parm_match %2d %5d [%s] [%s]\n", match, *specialization_priority, type, partial_parm_type);
   */
   Delete(t);
-  Delete(base);
-  Delete(ty);
   return match;
 }
 
+/* -----------------------------------------------------------------------------
+ * partial_candidates()
+ *
+ * Returns the partial specializations of the primary template templ that can
+ * match a first template argument whose typedef reduced type is ty (0 if
+ * unknown), in the order they were declared.
+ *
+ * Partial specializations are indexed on their first parameter.  Those where it
+ * is an explicit type, such as X<int, T>, can only match if the reduced
+ * argument is that exact type (see does_parm_match), so they are kept in
+ * "$partialindex" keyed on the type.  Those deducing it, such as X<T *, U>, are
+ * listed in "$partialwild" and are always candidates.  The index is extended
+ * as partial specializations are added to the template.
+ * ----------------------------------------------------------------------------- */
+
+static List *partial_candidates(Node *templ, SwigType *ty) {
+  List *partials = Getattr(templ, "partials");
+  Hash *index = Getattr(templ, "$partialindex");
+  List *wild = Getattr(templ, "$partialwild");
+  List *exact;
+  List *candidates;
+  int i, indexed, wi, ei, wlen, elen;
+
+  if (!index) {
+    index = NewHash();
+    wild = NewList();
+    Setattr(templ, "$partialindex", index);
+    Setattr(templ, "$partialwild", wild);
+    Delete(index);
+    Delete(wild);
+  }
+  indexed = GetInt(templ, "$partialindexed");
+  for (i = indexed; i < Len(partials); i++) {
+    Node *partial = Getitem(partials, i);
+    Parm *pp = Getattr(partial, "partialparms");
+    SwigType *pt = pp ? Getattr(pp, "type") : 0;
+    SetInt(partial, "$partialposition", i);
+    if (pt && !Strstr(pt, "$")) {
+      List *bucket = Getattr(index, pt);
+      if (!bucket) {
+	bucket = NewList();
+	Setattr(index, pt, bucket);
+	Delete(bucket);
+      }
+      Append(bucket, partial);
+    } else {
+      Append(wild, partial);
+    }
+  }
+  SetInt(templ, "$partialindexed", Len(partials));
+
+  if (!ty)
+    return Copy(partials);
+
+  /* Merge the exact matches for ty with the deduced ones in declaration order */
+  exact = Getattr(index, ty);
+  candidates = NewList();
+  wlen = Len(wild);
+  elen = exact ? Len(exact) : 0;
+  wi = 0;
+  ei = 0;
+  while (wi < wlen || ei < elen) {
+    Node *w = wi < wlen ? Getitem(wild, wi) : 0;
+    Node *e = ei < elen ? Getitem(exact, ei) : 0;
+    if (w && (!e || GetInt(w, "$partialposition") < GetInt(e, "$partialposition"))) {
+      Append(candidates, w);
+      wi++;
+    } else {
+      Append(candidates, e);
+      ei++;
+    }
+  }
+  return candidates;
+}
+
 /* -----------------------------------------------------------------------------
  * template_locate()
  *
@@ -618,6 +689,7 @@ static Node *template_locate(String *name, Parm *tparms, Symtab *tscope) {
   int *priorities_matrix = 0;
   int max_possible_partials = 0;
   int posslen = 0;
+  String *partial_key = 0;
 
   /* Search for primary (unspecialized) template */
   templ = Swig_symbol_clookup(name, 0);
@@ -716,43 +788,79 @@ static Node *template_locate(String *name, Parm *tparms, Symtab *tscope) {
 	Iterator pi;
 	int parms_len = ParmList_len(parms);
 	int *priorities_row;
-	max_possible_partials = Len(partials);
-	priorities_matrix = (int *)Malloc(sizeof(int) * max_possible_partials * parms_len); /* slightly wasteful allocation for max possible matches */
-	priorities_row = priorities_matrix;
-	for (pi = First(partials); pi.item; pi = Next(pi)) {
-	  Parm *p = parms;
-	  int all_parameters_match = 1;
-	  int i = 1;
-	  Parm *partialparms = Getattr(pi.item, "partialparms");
-	  Parm *pp = partialparms;
-	  String *templcsymname = Getattr(pi.item, "templcsymname");
-	  if (template_debug) {
-	    Printf(stdout, "    checking match: '%s' (partial specialization)\n", templcsymname);
+	int i;
+	List *reduced = NewList();	/* typedef reduced template arguments, "" if none */
+	List *bases = NewList();
+	List *candidates;
+	Hash *cache = Getattr(templ, "$partialcache");
+
+	partial_key = NewStringEmpty();
+
+	for (p = parms; p; p = nextSibling(p)) {
+	  SwigType *t = Getattr(p, "type");
+	  if (!t)
+	    t = Getattr(p, "value");
+	  if (t) {
+	    SwigType *ty = Swig_symbol_typedef_reduce(t, tscope);
+	    String *base = SwigType_base(ty);
+	    Append(reduced, ty);
+	    Append(bases, base);
+	    Delete(ty);
+	    Delete(base);
+	  } else {
+	    Append(reduced, "");
+	    Append(bases, "");
 	  }
-	  if (ParmList_len(partialparms) == parms_len) {
-	    while (p && pp) {
-	      SwigType *t;
-	      sprintf(tmp, "$%d", i);
-	      t = Getattr(p, "type");
-	      if (!t)
-		t = Getattr(p, "value");
-	      if (t) {
-		EMatch match = does_parm_match(t, Getattr(pp, "type"), tmp, tscope, priorities_row + i - 1);
-		if (match < (int)PartiallySpecializedMatch) {
-		  all_parameters_match = 0;
-		  break;
+	  Printf(partial_key, "%s%s", Len(partial_key) ? "," : "", Getitem(reduced, Len(reduced) - 1));
+	}
+
+	/* The chosen partial specialization only depends on the reduced arguments and the partial specializations declared so far */
+	if (cache && GetInt(templ, "$partialcachelen") != Len(partials)) {
+	  Delattr(templ, "$partialcache");
+	  cache = 0;
+	}
+	if (cache && !template_debug && Getattr(cache, partial_key)) {
+	  int chosen = GetInt(cache, partial_key);
+	  if (chosen >= 0)
+	    Append(possiblepartials, Getitem(partials, chosen));
+	  Delete(partial_key);
+	  partial_key = 0;
+	} else {
+	  max_possible_partials = Len(partials);
+	  priorities_matrix = (int *)Malloc(sizeof(int) * max_possible_partials * parms_len); /* slightly wasteful allocation for max possible matches */
+	  priorities_row = priorities_matrix;
+	  candidates = partial_candidates(templ, (parms_len > 0 && Len(Getitem(reduced, 0))) ? Getitem(reduced, 0) : 0);
+	  for (pi = First(candidates); pi.item; pi = Next(pi)) {
+	    int all_parameters_match = 1;
+	    Parm *partialparms = Getattr(pi.item, "partialparms");
+	    Parm *pp = partialparms;
+	    String *templcsymname = Getattr(pi.item, "templcsymname");
+	    if (template_debug) {
+	      Printf(stdout, "    checking match: '%s' (partial specialization)\n", templcsymname);
+	    }
+	    if (ParmList_len(partialparms) == parms_len) {
+	      for (i = 1; i <= parms_len && pp; i++) {
+		SwigType *ty = Getitem(reduced, i - 1);
+		sprintf(tmp, "$%d", i);
+		if (Len(ty)) {
+		  EMatch match = does_parm_match(ty, Getitem(bases, i - 1), Getattr(pp, "type"), tmp, priorities_row + i - 1);
+		  if (match < (int)PartiallySpecializedMatch) {
+		    all_parameters_match = 0;
+		    break;
+		  }
 		}
+		pp = nextSibling(pp);
+	      }
+	      if (all_parameters_match) {
+		Append(possiblepartials, pi.item);
+		priorities_row += parms_len;
 	      }
-	      i++;
-	      p = nextSibling(p);
-	      pp = nextSibling(pp);
-	    }
-	    if (all_parameters_match) {
-	      Append(possiblepartials, pi.item);
-	      priorities_row += parms_len;
 	    }
 	  }
+	  Delete(candidates);
 	}
+	Delete(reduced);
+	Delete(bases);
       }
     }
 
@@ -863,6 +971,18 @@ static Node *template_locate(String *name, Parm *tparms, Symtab *tscope) {
       }
     }
 
+    if (partial_key && posslen <= 1) {
+      /* Remember unambiguous results as the position of the chosen partial specialization, -1 if none matched */
+      Hash *cache = Getattr(templ, "$partialcache");
+      if (!cache) {
+	cache = NewHash();
+	Setattr(templ, "$partialcache", cache);
+	SetInt(templ, "$partialcachelen", Len(Getattr(templ, "partials")));
+	Delete(cache);
+      }
+      SetInt(cache, partial_key, posslen ? GetInt(Getitem(possiblepartials, 0), "$partialposition") : -1);
+    }
+
     if (posslen > 0) {
       String *s = Getattr(Getitem(possiblepartials, 0), "templcsymname");
       n = Swig_symbol_clookup_local(s, primary_scope);
@@ -906,6 +1026,7 @@ static Node *template_locate(String *name, Parm *tparms, Symtab *tscope) {
   }
 success:
   Delete(tname);
+  Delete(partial_key);
   Delete(possiblepartials);
   if ((template_debug) && (n)) {
     /*
@@ -104,6 +104,9 @@
 #define DohNewFileFromFd   DOH_NAMESPACE(NewFileFromFd)
 #define DohFileErrorDisplay   DOH_NAMESPACE(FileErrorDisplay)
 #define DohCopyto          DOH_NAMESPACE(Copyto)
+#define DohNewRope         DOH_NAMESPACE(NewRope)
+#define DohRopeSpill       DOH_NAMESPACE(RopeSpill)
+#define DohRopeStream      DOH_NAMESPACE(RopeStream)
 #define DohNewList         DOH_NAMESPACE(NewList)
 #define DohNewHash         DOH_NAMESPACE(NewHash)
 #define DohNewVoid         DOH_NAMESPACE(NewVoid)
@@ -126,6 +129,9 @@
 #define DohRealloc         DOH_NAMESPACE(Realloc)
 #define DohCalloc          DOH_NAMESPACE(Calloc)
 #define DohFree            DOH_NAMESPACE(Free)
+#define DohArenaEnable     DOH_NAMESPACE(ArenaEnable)
+#define DohArenaEnabled    DOH_NAMESPACE(ArenaEnabled)
+#define DohArenaRelease    DOH_NAMESPACE(ArenaRelease)
 #define DohSetExitHandler  DOH_NAMESPACE(SetExitHandler)
 #define DohExit            DOH_NAMESPACE(Exit)
 #endif
@@ -178,6 +184,11 @@ extern void *DohCalloc(size_t n, size_t size);
 #define DohFree free
 #endif
 
+/* Arena allocation of object data.  Must be selected before any object is created. */
+extern int DohArenaEnable(int on);
+extern int DohArenaEnabled(void);
+extern void DohArenaRelease(void);
+
 extern int DohCheck(const DOH *ptr);	/* Check if a DOH object */
 extern void DohIntern(DOH *);	/* Intern an object      */
 
@@ -334,6 +345,14 @@ extern void DohFileErrorDisplay(DOHString * filename);
 extern int DohCopyto(DOHFile * input, DOHFile * output);
 extern void DohCloseAllOpenFiles(void);
 
+/* -----------------------------------------------------------------------------
+ * Ropes (segmented output buffers)
+ * ----------------------------------------------------------------------------- */
+
+extern DOHFile *DohNewRope(void);
+extern void DohRopeSpill(DOHFile * rope, int threshold);
+extern int DohRopeStream(DOHFile * rope, DOHFile * output);
+
 
 /* -----------------------------------------------------------------------------
  * List
@@ -452,6 +471,9 @@ extern void DohMemoryDebug(void);
 #define Strstr             DohStrstr
 #define Strchr             DohStrchr
 #define Copyto             DohCopyto
+#define NewRope            DohNewRope
+#define RopeSpill          DohRopeSpill
+#define RopeStream         DohRopeStream
 #define CloseAllOpenFiles  DohCloseAllOpenFiles
 #define Split              DohSplit
 #define SplitLines         DohSplitLines
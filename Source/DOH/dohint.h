@@ -128,4 +128,14 @@ typedef struct {
 extern DOH *DohObjMalloc(DohObjInfo *type, void *data);	/* Allocate a DOH object */
 extern void DohObjFree(DOH *ptr);	/* Free a DOH object     */
 
+/* File descriptor of a file object for direct output, see rope.c */
+extern int DohFileDescriptor(DOH *fo);
+extern void DohFileSync(DOH *fo);
+
+/* Object data allocators, see DohArenaEnable() */
+extern void *DohArenaMalloc(size_t size);
+extern void *DohArenaCalloc(size_t n, size_t size);
+extern void *DohArenaRealloc(void *ptr, size_t size);
+extern void DohArenaFree(void *ptr);
+
 #endif				/* SWIG_DOHINT_H */
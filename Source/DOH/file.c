@@ -14,7 +14,7 @@
 
 #include "dohint.h"
 
-#ifdef DOH_INTFILE
+#if defined(DOH_INTFILE) || !defined(_WIN32)
 #include <unistd.h>
 #endif
 #include <errno.h>
@@ -272,6 +272,50 @@ static DohObjInfo DohFileType = {
   0,				/* doh_position */
 };
 
+/* -----------------------------------------------------------------------------
+ * DohFileDescriptor()
+ *
+ * Returns the file descriptor of a file object, after flushing any buffered
+ * output, so that it can be written to directly.  Returns -1 if fo is not a
+ * file object.  DohFileSync() must be called after writing to the descriptor.
+ * ----------------------------------------------------------------------------- */
+
+int DohFileDescriptor(DOH *fo) {
+  DohFile *f;
+  if (!DohCheck(fo) || ObjType(fo) != &DohFileType)
+    return -1;
+  f = (DohFile *) ObjData(fo);
+  if (f->filep) {
+    if (fflush(f->filep) != 0)
+      return -1;
+    return fileno(f->filep);
+  } else if (f->fd) {
+#ifdef DOH_INTFILE
+    return f->fd;
+#endif
+  }
+  return -1;
+}
+
+/* -----------------------------------------------------------------------------
+ * DohFileSync()
+ *
+ * Updates the FILE * position after its file descriptor was written to.
+ * ----------------------------------------------------------------------------- */
+
+void DohFileSync(DOH *fo) {
+#ifndef _WIN32
+  DohFile *f = (DohFile *) ObjData(fo);
+  if (f->filep) {
+    long pos = (long) lseek(fileno(f->filep), 0, SEEK_CUR);
+    if (pos >= 0)
+      fseek(f->filep, pos, SEEK_SET);
+  }
+#else
+  (void)fo;
+#endif
+}
+
 /* -----------------------------------------------------------------------------
  * NewFile()
  *
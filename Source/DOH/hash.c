@@ -22,70 +22,157 @@ typedef struct HashNode {
   struct HashNode *next;
 } HashNode;
 
-/* Hash object */
+/* Entry in a small hash */
+typedef struct SmallEntry {
+  DOH *key;
+  DOH *object;
+  int hashval;
+} SmallEntry;
+
+/* Hash object.
+ *
+ * Most hashes (parse tree nodes in particular) only ever hold a handful of
+ * attributes, so a hash starts out as a small vector of entries and only
+ * switches to a table of chained HashNodes once it holds more than
+ * HASH_SMALL_MAX items (when hashtable becomes non-null).  The small entries
+ * are kept in the order the chained table would iterate over them, that is by
+ * bucket (hash value modulo HASH_INIT_SIZE) and then by insertion order, so
+ * iteration order does not depend on the layout in use. */
 typedef struct Hash {
   DOH *file;
   int line;
   HashNode **hashtable;
   int hashsize;
   int nitems;
+  SmallEntry *small;
+  int smallmax;
 } Hash;
 
-/* Key interning structure */
+/* -----------------------------------------------------------------------------
+ * Key interning
+ *
+ * Attribute names passed as C strings, as in Getattr(n, "name"), are mapped to
+ * a single interned String.  The interned keys are held in an open addressing
+ * table with linear probing that stores the hash value of each key, so a known
+ * key is normally found with one probe and a single strcmp().  The table is
+ * pre-sized and seeded with the attribute names used most by the SWIG core and
+ * the language modules.
+ * ----------------------------------------------------------------------------- */
+
 typedef struct KeyValue {
+  unsigned int hashval;
   char *cstr;
   DOH *sstr;
-  struct KeyValue *left;
-  struct KeyValue *right;
 } KeyValue;
 
-static KeyValue *root = 0;
+#define KEYTABLE_INIT_SIZE  1024	/* Must be a power of 2 */
+
+static KeyValue *keytable = 0;
+static unsigned int keytable_size = 0;
+static unsigned int keytable_used = 0;
 static int max_expand = 1;
 
+static const char *const preseeded_keys[] = {
+  "name", "type", "decl", "sym:name", "value", "parms", "storage", "nodeType",
+  "kind", "code", "access", "symtab", "sym:symtab", "sym:nextSibling",
+  "sym:previousSibling", "sym:overloaded", "sym:overname", "sym:weak",
+  "sym:typename", "sym:nspace", "csym:nextSibling", "feature:ignore",
+  "feature:immutable", "feature:onlychildren", "feature:nodirector",
+  "feature:extend", "feature:new", "feature:director", "feature:flatnested",
+  "wrap:action", "wrap:name", "wrap:parms", "tmap:in", "tmap:in:next",
+  "tmap:in:numinputs", "tmap:out", "tmap:typecheck", "tmap:typecheck:precedence",
+  "tmap:argout", "tmap:freearg", "tmap:check", "tmap:default", "tmap:match",
+  "nested:outer", "uname", "lname", "tdname", "qname", "templatetype",
+  "templateparms", "template", "pattern", "throws", "throw", "abstracts",
+  "parentNode", "firstChild", "lastChild", "nextSibling", "previousSibling",
+  "kwargs", "typescope", "class_rename", "unnamed", "module", "error",
+  "namespace", "inherit", "view", "refqualifier", "final", "classtype",
+  "allbases", "bases", "typetab", "section", "ismember", "hidden",
+  "defaultargs", "noexcept", "conversion_operator", "parent", "locals",
+  "enumvalue", "alias", "allocate:default_constructor",
+  "allocate:copy_constructor", "allocate:noassign", "allocate:smartpointer",
+  "allocate:has_constructor", "allocate:default_destructor", "emit:input",
+  "staticmembervariableHandler:sym:name", "memberfunctionHandler:sym:name",
+  "parsing_template_declaration",
+  0
+};
+
+/* djb2 over the whole key, with the usual seed as the table uses linear probing */
+static unsigned int key_hash(const char *c) {
+  unsigned int h = 5381;
+  while (*c) {
+    h = h + (h << 5) + (unsigned char) *(c++);
+  }
+  return h;
+}
+
+static void keytable_insert(KeyValue *kv) {
+  unsigned int mask = keytable_size - 1;
+  unsigned int i = kv->hashval & mask;
+  while (keytable[i].sstr)
+    i = (i + 1) & mask;
+  keytable[i] = *kv;
+}
+
+static void keytable_grow(void) {
+  KeyValue *old = keytable;
+  unsigned int oldsize = keytable_size;
+  unsigned int i;
+  keytable_size = oldsize ? oldsize * 2 : KEYTABLE_INIT_SIZE;
+  keytable = (KeyValue *) DohCalloc(keytable_size, sizeof(KeyValue));
+  for (i = 0; i < oldsize; i++) {
+    if (old[i].sstr)
+      keytable_insert(&old[i]);
+  }
+  DohFree(old);
+}
+
+static DOH *find_key(DOH *doh_c);
+
+static void keytable_init(void) {
+  const char *const *k;
+  keytable_grow();
+  for (k = preseeded_keys; *k; k++)
+    find_key((DOH *) *k);
+}
+
 /* Find or create a key in the interned key table */
 static DOH *find_key(DOH *doh_c) {
-  char *c = (char *) doh_c;
-  KeyValue *r, *s;
-  int d = 0;
-  /* OK, sure, we use a binary tree for maintaining interned
-     symbols.  Then we use their hash values for accessing secondary
-     hash tables. */
-  r = root;
-  s = 0;
-  while (r) {
-    s = r;
-    d = strcmp(r->cstr, c);
-    if (d == 0)
-      return r->sstr;
-    if (d < 0)
-      r = r->left;
-    else
-      r = r->right;
+  const char *c = (const char *) doh_c;
+  unsigned int hv, mask, i;
+  KeyValue kv;
+
+  if (!keytable)
+    keytable_init();
+  hv = key_hash(c);
+  mask = keytable_size - 1;
+  i = hv & mask;
+  while (keytable[i].sstr) {
+    if (keytable[i].hashval == hv && strcmp(keytable[i].cstr, c) == 0)
+      return keytable[i].sstr;
+    i = (i + 1) & mask;
   }
+
   /*  fprintf(stderr,"Interning '%s'\n", c); */
-  r = (KeyValue *) DohMalloc(sizeof(KeyValue));
-  r->cstr = (char *) DohMalloc(strlen(c) + 1);
-  strcpy(r->cstr, c);
-  r->sstr = NewString(c);
-  DohIntern(r->sstr);
-  r->left = 0;
-  r->right = 0;
-  if (!s) {
-    root = r;
-  } else {
-    if (d < 0)
-      s->left = r;
-    else
-      s->right = r;
-  }
-  return r->sstr;
+  kv.hashval = hv;
+  kv.cstr = (char *) DohMalloc(strlen(c) + 1);
+  strcpy(kv.cstr, c);
+  kv.sstr = NewString(c);
+  DohIntern(kv.sstr);
+  if (2 * (keytable_used + 1) > keytable_size)
+    keytable_grow();
+  keytable_insert(&kv);
+  keytable_used++;
+  return kv.sstr;
 }
 
 #define HASH_INIT_SIZE   7
+#define HASH_SMALL_INIT  4
+#define HASH_SMALL_MAX   (3 * HASH_INIT_SIZE - 1)	/* Largest small hash, resize() grows the chained table beyond this */
 
 /* Create a new hash node */
 static HashNode *NewNode(DOH *k, void *obj) {
-  HashNode *hn = (HashNode *) DohMalloc(sizeof(HashNode));
+  HashNode *hn = (HashNode *) DohArenaMalloc(sizeof(HashNode));
   hn->key = k;
   Incref(hn->key);
   hn->object = obj;
@@ -98,7 +185,7 @@ static HashNode *NewNode(DOH *k, void *obj) {
 static void DelNode(HashNode *hn) {
   Delete(hn->key);
   Delete(hn->object);
-  DohFree(hn);
+  DohArenaFree(hn);
 }
 
 /* -----------------------------------------------------------------------------
@@ -112,6 +199,16 @@ static void DelHash(DOH *ho) {
   HashNode *n, *next;
   int i;
 
+  if (!h->hashtable) {
+    for (i = 0; i < h->nitems; i++) {
+      Delete(h->small[i].key);
+      Delete(h->small[i].object);
+    }
+    DohArenaFree(h->small);
+    h->small = 0;
+    DohArenaFree(h);
+    return;
+  }
   for (i = 0; i < h->hashsize; i++) {
     n = h->hashtable[i];
     while (n) {
@@ -120,10 +217,10 @@ static void DelHash(DOH *ho) {
       n = next;
     }
   }
-  DohFree(h->hashtable);
+  DohArenaFree(h->hashtable);
   h->hashtable = 0;
   h->hashsize = 0;
-  DohFree(h);
+  DohArenaFree(h);
 }
 
 /* -----------------------------------------------------------------------------
@@ -137,6 +234,14 @@ static void Hash_clear(DOH *ho) {
   HashNode *n, *next;
   int i;
 
+  if (!h->hashtable) {
+    for (i = 0; i < h->nitems; i++) {
+      Delete(h->small[i].key);
+      Delete(h->small[i].object);
+    }
+    h->nitems = 0;
+    return;
+  }
   for (i = 0; i < h->hashsize; i++) {
     n = h->hashtable[i];
     while (n) {
@@ -173,7 +278,7 @@ static void resize(Hash *h) {
     p = p + 2;
   }
 
-  table = (HashNode **) DohCalloc(newsize, sizeof(HashNode *));
+  table = (HashNode **) DohArenaCalloc(newsize, sizeof(HashNode *));
 
   /* Walk down the old set of nodes and re-place */
   h->hashsize = newsize;
@@ -187,10 +292,65 @@ static void resize(Hash *h) {
       n = next;
     }
   }
-  DohFree(h->hashtable);
+  DohArenaFree(h->hashtable);
   h->hashtable = table;
 }
 
+/* Find the entry for a key in a small hash */
+static SmallEntry *small_find(Hash *h, DOH *k, int hv) {
+  SmallEntry *e = h->small;
+  SmallEntry *end = e + h->nitems;
+  for (; e != end; e++) {
+    if ((e->hashval == hv) && (Cmp(e->key, k) == 0))
+      return e;
+  }
+  return 0;
+}
+
+/* Add a new entry to a small hash, after any existing entries in the same bucket */
+static void small_insert(Hash *h, DOH *k, DOH *obj, int hv) {
+  int bucket = hv % HASH_INIT_SIZE;
+  int i = h->nitems;
+  if (h->nitems == h->smallmax) {
+    h->smallmax *= 2;
+    if (h->smallmax > HASH_SMALL_MAX)
+      h->smallmax = HASH_SMALL_MAX;
+    h->small = (SmallEntry *) DohArenaRealloc(h->small, h->smallmax * sizeof(SmallEntry));
+  }
+  while (i > 0 && (h->small[i - 1].hashval % HASH_INIT_SIZE) > bucket)
+    i--;
+  if (i < h->nitems)
+    memmove(&h->small[i + 1], &h->small[i], (h->nitems - i) * sizeof(SmallEntry));
+  h->small[i].key = k;
+  Incref(k);
+  h->small[i].object = obj;
+  Incref(obj);
+  h->small[i].hashval = hv;
+  h->nitems++;
+}
+
+/* Switch a full small hash over to the chained table, preserving iteration order */
+static void small_to_chained(Hash *h) {
+  HashNode **tails[HASH_INIT_SIZE];
+  int i;
+  h->hashsize = HASH_INIT_SIZE;
+  h->hashtable = (HashNode **) DohArenaCalloc(h->hashsize, sizeof(HashNode *));
+  for (i = 0; i < h->hashsize; i++)
+    tails[i] = &h->hashtable[i];
+  for (i = 0; i < h->nitems; i++) {
+    HashNode *n = (HashNode *) DohArenaMalloc(sizeof(HashNode));
+    int hv = h->small[i].hashval % h->hashsize;
+    n->key = h->small[i].key;
+    n->object = h->small[i].object;
+    n->next = 0;
+    *tails[hv] = n;
+    tails[hv] = &n->next;
+  }
+  DohArenaFree(h->small);
+  h->small = 0;
+  h->smallmax = 0;
+}
+
 /* -----------------------------------------------------------------------------
  * Hash_setattr()
  *
@@ -212,6 +372,24 @@ static int Hash_setattr(DOH *ho, DOH *k, DOH *obj) {
     obj = NewString((char *) obj);
     Decref(obj);
   }
+  if (!h->hashtable) {
+    SmallEntry *e;
+    hv = Hashval(k);
+    e = small_find(h, k, hv);
+    if (e) {
+      if (e->object == obj)
+	return 1;
+      Delete(e->object);
+      e->object = obj;
+      Incref(obj);
+      return 1;
+    }
+    if (h->nitems < HASH_SMALL_MAX) {
+      small_insert(h, k, obj, hv);
+      return 0;
+    }
+    small_to_chained(h);
+  }
   hv = (Hashval(k)) % h->hashsize;
   n = h->hashtable[hv];
   prev = 0;
@@ -254,9 +432,30 @@ static DOH *Hash_getattr(DOH *h, DOH *k) {
   DOH *obj = 0;
   Hash *ho = (Hash *) ObjData(h);
   DOH *ko = DohCheck(k) ? k : find_key(k);
-  int hv = Hashval(ko) % ho->hashsize;
   DohObjInfo *k_type = ((DohBase*)ko)->type;
-  HashNode *n = ho->hashtable[hv];
+  HashNode *n;
+  int hv;
+  if (!ho->hashtable) {
+    SmallEntry *e = ho->small;
+    SmallEntry *end = e + ho->nitems;
+    hv = Hashval(ko);
+    if (k_type->doh_equal) {
+      binop equal = k_type->doh_equal;
+      for (; e != end; e++) {
+	if ((e->hashval == hv) && (k_type == ((DohBase *)e->key)->type) && equal(ko, e->key))
+	  return e->object;
+      }
+    } else {
+      binop cmp = k_type->doh_cmp;
+      for (; e != end; e++) {
+	if ((e->hashval == hv) && (k_type == ((DohBase *)e->key)->type) && (cmp(ko, e->key) == 0))
+	  return e->object;
+      }
+    }
+    return 0;
+  }
+  hv = Hashval(ko) % ho->hashsize;
+  n = ho->hashtable[hv];
   if (k_type->doh_equal) {
     binop equal = k_type->doh_equal;
     while (n) {
@@ -288,6 +487,16 @@ static int Hash_delattr(DOH *ho, DOH *k) {
 
   if (!DohCheck(k))
     k = find_key(k);
+  if (!h->hashtable) {
+    SmallEntry *e = small_find(h, k, Hashval(k));
+    if (!e)
+      return 0;
+    Delete(e->key);
+    Delete(e->object);
+    h->nitems--;
+    memmove(e, e + 1, (h->nitems - (e - h->small)) * sizeof(SmallEntry));
+    return 1;
+  }
   hv = Hashval(k) % h->hashsize;
   n = h->hashtable[hv];
   prev = 0;
@@ -310,6 +519,25 @@ static int Hash_delattr(DOH *ho, DOH *k) {
   return 0;
 }
 
+/* Iterators over a small hash use a negative _index (-2 - position of the
+   current entry) and keep the current key in _current.  If the current entry
+   is deleted, the next one moves into its position. */
+#define SMALL_ITER_INDEX(pos) (-2 - (pos))
+
+static DohIterator small_iter_at(DohIterator iter, Hash *h, int pos) {
+  if (pos >= h->nitems) {
+    iter.item = 0;
+    iter.key = 0;
+    iter._current = 0;
+    return iter;
+  }
+  iter.key = h->small[pos].key;
+  iter.item = h->small[pos].object;
+  iter._current = iter.key;
+  iter._index = SMALL_ITER_INDEX(pos);
+  return iter;
+}
+
 static DohIterator Hash_firstiter(DOH *ho) {
   DohIterator iter;
   Hash *h = (Hash *) ObjData(ho);
@@ -317,6 +545,8 @@ static DohIterator Hash_firstiter(DOH *ho) {
   iter._current = 0;
   iter.item = 0;
   iter.key = 0;
+  if (!h->hashtable)
+    return small_iter_at(iter, h, 0);
   iter._index = 0;		/* Index in hash table */
   while ((iter._index < h->hashsize) && !h->hashtable[iter._index])
     iter._index++;
@@ -336,6 +566,29 @@ static DohIterator Hash_firstiter(DOH *ho) {
 
 static DohIterator Hash_nextiter(DohIterator iter) {
   Hash *h = (Hash *) ObjData(iter.object);
+  if (iter._index < -1) {
+    int pos = SMALL_ITER_INDEX(iter._index);
+    if (!h->hashtable) {
+      if ((pos < h->nitems) && (h->small[pos].key == iter._current))
+	pos++;
+      return small_iter_at(iter, h, pos);
+    } else {
+      /* The hash grew into a chained table during iteration, which keeps the
+         same order, so carry on from the current key's node */
+      int hv = Hashval(iter._current) % h->hashsize;
+      HashNode *n = h->hashtable[hv];
+      while (n && n->key != iter._current)
+	n = n->next;
+      if (!n) {
+	iter.item = 0;
+	iter.key = 0;
+	iter._current = 0;
+	return iter;
+      }
+      iter._index = hv;
+      iter._current = n->next;
+    }
+  }
   if (!iter._current) {
     iter._index++;
     while ((iter._index < h->hashsize) && !h->hashtable[iter._index]) {
@@ -416,7 +669,9 @@ static DOH *Hash_str(DOH *ho) {
   if (expanded >= max_expand) {
     /* replace each hash attribute with a '.' */
     Printf(s, "Hash(%p) {", ho);
-    for (i = 0; i < h->hashsize; i++) {
+    for (i = 0; !h->hashtable && i < h->nitems; i++)
+      Putc('.', s);
+    for (i = 0; h->hashtable && i < h->hashsize; i++) {
       n = h->hashtable[i];
       while (n) {
 	Putc('.', s);
@@ -428,7 +683,14 @@ static DOH *Hash_str(DOH *ho) {
   }
   ObjSetMark(ho, 1);
   Printf(s, "Hash(%p) {\n", ho);
-  for (i = 0; i < h->hashsize; i++) {
+  for (i = 0; !h->hashtable && i < h->nitems; i++) {
+    for (j = 0; j < expanded + 1; j++)
+      Printf(s, tab);
+    expanded += 1;
+    Printf(s, "'%s' : %s, \n", h->small[i].key, h->small[i].object);
+    expanded -= 1;
+  }
+  for (i = 0; h->hashtable && i < h->hashsize; i++) {
     n = h->hashtable[i];
     while (n) {
       for (j = 0; j < expanded + 1; j++)
@@ -470,9 +732,28 @@ static DOH *CopyHash(DOH *ho) {
 
   int i;
   h = (Hash *) ObjData(ho);
-  nh = (Hash *) DohMalloc(sizeof(Hash));
+  nh = (Hash *) DohArenaMalloc(sizeof(Hash));
+  if (!h->hashtable) {
+    nh->hashtable = 0;
+    nh->hashsize = HASH_INIT_SIZE;
+    nh->nitems = h->nitems;
+    nh->smallmax = h->nitems > HASH_SMALL_INIT ? h->nitems : HASH_SMALL_INIT;
+    nh->small = (SmallEntry *) DohArenaMalloc(nh->smallmax * sizeof(SmallEntry));
+    for (i = 0; i < h->nitems; i++) {
+      nh->small[i] = h->small[i];
+      Incref(nh->small[i].key);
+      Incref(nh->small[i].object);
+    }
+    nh->line = h->line;
+    nh->file = h->file;
+    if (nh->file)
+      Incref(nh->file);
+    return DohObjMalloc(&DohHashType, nh);
+  }
+  nh->small = 0;
+  nh->smallmax = 0;
   nh->hashsize = h->hashsize;
-  nh->hashtable = (HashNode **) DohMalloc(nh->hashsize * sizeof(HashNode *));
+  nh->hashtable = (HashNode **) DohArenaMalloc(nh->hashsize * sizeof(HashNode *));
   for (i = 0; i < nh->hashsize; i++) {
     nh->hashtable[i] = 0;
   }
@@ -569,13 +850,11 @@ DohObjInfo DohHashType = {
 
 DOH *DohNewHash(void) {
   Hash *h;
-  int i;
-  h = (Hash *) DohMalloc(sizeof(Hash));
+  h = (Hash *) DohArenaMalloc(sizeof(Hash));
   h->hashsize = HASH_INIT_SIZE;
-  h->hashtable = (HashNode **) DohMalloc(h->hashsize * sizeof(HashNode *));
-  for (i = 0; i < h->hashsize; i++) {
-    h->hashtable[i] = 0;
-  }
+  h->hashtable = 0;
+  h->smallmax = HASH_SMALL_INIT;
+  h->small = (SmallEntry *) DohArenaMalloc(h->smallmax * sizeof(SmallEntry));
   h->nitems = 0;
   h->file = 0;
   h->line = 0;
@@ -26,7 +26,7 @@ extern DohObjInfo DohListType;
 /* Doubles amount of memory in a list */
 static
 void more(List *l) {
-  l->items = (void **) DohRealloc(l->items, l->maxitems * 2 * sizeof(void *));
+  l->items = (void **) DohArenaRealloc(l->items, l->maxitems * 2 * sizeof(void *));
   l->maxitems *= 2;
 }
 
@@ -39,10 +39,10 @@ static DOH *CopyList(DOH *lo) {
   List *l, *nl;
   int i;
   l = (List *) ObjData(lo);
-  nl = (List *) DohMalloc(sizeof(List));
+  nl = (List *) DohArenaMalloc(sizeof(List));
   nl->nitems = l->nitems;
   nl->maxitems = l->maxitems;
-  nl->items = (void **) DohMalloc(l->maxitems * sizeof(void *));
+  nl->items = (void **) DohArenaMalloc(l->maxitems * sizeof(void *));
   for (i = 0; i < l->nitems; i++) {
     nl->items[i] = l->items[i];
     Incref(nl->items[i]);
@@ -65,8 +65,8 @@ static void DelList(DOH *lo) {
   int i;
   for (i = 0; i < l->nitems; i++)
     Delete(l->items[i]);
-  DohFree(l->items);
-  DohFree(l);
+  DohArenaFree(l->items);
+  DohArenaFree(l);
 }
 
 /* -----------------------------------------------------------------------------
@@ -345,10 +345,10 @@ DohObjInfo DohListType = {
 #define MAXLISTITEMS 8
 
 DOH *DohNewList(void) {
-  List *l = (List *) DohMalloc(sizeof(List));
+  List *l = (List *) DohArenaMalloc(sizeof(List));
   l->nitems = 0;
   l->maxitems = MAXLISTITEMS;
-  l->items = (void **) DohCalloc(l->maxitems, sizeof(void *));
+  l->items = (void **) DohArenaCalloc(l->maxitems, sizeof(void *));
   l->file = 0;
   l->line = 0;
   return DohObjMalloc(&DohListType, l);
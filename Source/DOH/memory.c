@@ -44,6 +44,73 @@ static DohBase *FreeList = 0;	/* List of free objects */
 static Pool *Pools = 0;
 static int pools_initialized = 0;
 
+/* -----------------------------------------------------------------------------
+ * Arena allocator for object data
+ *
+ * The DohBase headers above live in fixed size pools, but the data hanging off
+ * them (String buffers, Hash tables and nodes, List item arrays) is allocated
+ * one block at a time.  When the arena is enabled these blocks are carved out
+ * of large chunks, one bump pointer per size class, and recycled through a
+ * per class free list.  Blocks too big for any size class are malloc'ed but
+ * still tracked so that DohArenaRelease() can hand everything back in one go.
+ *
+ * Each block is preceded by a small header recording its size class, so
+ * DohArenaRealloc() and DohArenaFree() have the same signature as their libc
+ * counterparts.  The arena can only be switched on or off before the first
+ * block is handed out, as blocks from the two schemes cannot be mixed.
+ * ----------------------------------------------------------------------------- */
+
+#ifndef DOH_ARENA_CHUNK_SIZE
+#define DOH_ARENA_CHUNK_SIZE  262144
+#endif
+
+#define ARENA_MAX_BLOCK       1024	/* Largest block, header included, served from a size class */
+#define ARENA_LARGE           0xff	/* Size class marker for malloc'ed blocks */
+
+typedef union ArenaHeader {
+  unsigned char sclass;		/* Size class index or ARENA_LARGE */
+  double align;
+  void *palign;
+} ArenaHeader;
+
+typedef struct ArenaLarge {
+  struct ArenaLarge *prev;
+  struct ArenaLarge *next;
+  ArenaHeader header;
+} ArenaLarge;
+
+typedef struct ArenaChunk {
+  struct ArenaChunk *next;
+  ArenaHeader align;
+} ArenaChunk;
+
+typedef struct ArenaClass {
+  size_t size;			/* Block size including the header */
+  char *bump;			/* Next unused block in the current chunk */
+  char *bumpend;		/* End of the current chunk */
+  ArenaHeader *freelist;	/* Recycled blocks */
+  long nalloc;			/* Number of allocations */
+  long nreused;			/* Allocations satisfied from the free list */
+} ArenaClass;
+
+static const size_t ArenaSizes[] = { 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024 };
+#define ARENA_NCLASSES ((int)(sizeof(ArenaSizes)/sizeof(ArenaSizes[0])))
+
+static ArenaClass ArenaClasses[ARENA_NCLASSES];
+static unsigned char ArenaClassOf[ARENA_MAX_BLOCK / 8 + 1];	/* Block size in 8 byte units -> size class */
+static ArenaChunk *ArenaChunks = 0;
+static ArenaLarge *ArenaLargeBlocks = 0;
+static long ArenaNumChunks = 0;
+static long ArenaNumLarge = 0;
+
+#ifdef DOH_ARENA
+static int arena_enabled = 1;
+#else
+static int arena_enabled = 0;
+#endif
+static int arena_latched = 0;	/* Set once a block has been handed out */
+static int arena_initialized = 0;
+
 /* ----------------------------------------------------------------------
  * CreatePool() - Create a new memory pool 
  * ---------------------------------------------------------------------- */
@@ -218,6 +285,18 @@ void DohMemoryDebug(void) {
   printf("    Lists     : %d\n", numlist);
   printf("    Hashes    : %d\n", numhash);
 
+  if (arena_enabled && arena_initialized) {
+    int i;
+    printf("\nArena:\n");
+    for (i = 0; i < ARENA_NCLASSES; i++) {
+      ArenaClass *ac = &ArenaClasses[i];
+      if (ac->nalloc)
+	printf("    Class %5d: allocs = %10ld, reused = %10ld\n", (int) ac->size, ac->nalloc, ac->nreused);
+    }
+    printf("    Chunks    : %ld (%d bytes each)\n", ArenaNumChunks, DOH_ARENA_CHUNK_SIZE);
+    printf("    Large     : %ld\n", ArenaNumLarge);
+  }
+
 #if 0
   p = Pools;
   while (p) {
@@ -235,6 +314,213 @@ void DohMemoryDebug(void) {
 
 }
 
+/* ----------------------------------------------------------------------
+ * DohArenaEnable()
+ *
+ * Select whether object data comes from the arena.  Returns 1 if the request
+ * was honoured, 0 if data has already been allocated with the other scheme.
+ * ---------------------------------------------------------------------- */
+
+int DohArenaEnable(int on) {
+  on = on ? 1 : 0;
+  if (arena_latched)
+    return arena_enabled == on;
+  arena_enabled = on;
+  return 1;
+}
+
+int DohArenaEnabled(void) {
+  return arena_enabled;
+}
+
+static void InitArena(void) {
+  int i, c = 0;
+  for (i = 0; i < ARENA_NCLASSES; i++) {
+    ArenaClasses[i].size = ArenaSizes[i];
+    ArenaClasses[i].bump = 0;
+    ArenaClasses[i].bumpend = 0;
+    ArenaClasses[i].freelist = 0;
+    ArenaClasses[i].nalloc = 0;
+    ArenaClasses[i].nreused = 0;
+  }
+  for (i = 0; i <= ARENA_MAX_BLOCK / 8; i++) {
+    while (ArenaSizes[c] < (size_t) i * 8)
+      c++;
+    ArenaClassOf[i] = (unsigned char) c;
+  }
+  arena_initialized = 1;
+}
+
+/* Carve a new chunk for the given size class */
+static void ArenaRefill(ArenaClass *ac) {
+  size_t nbytes = DOH_ARENA_CHUNK_SIZE;
+  ArenaChunk *chunk;
+  if (nbytes < sizeof(ArenaChunk) + ac->size * 16)
+    nbytes = sizeof(ArenaChunk) + ac->size * 16;
+  chunk = (ArenaChunk *) DohMalloc(nbytes);
+  chunk->next = ArenaChunks;
+  ArenaChunks = chunk;
+  ArenaNumChunks++;
+  ac->bump = (char *) (chunk + 1);
+  ac->bumpend = ((char *) chunk) + nbytes;
+}
+
+static void *ArenaLargeMalloc(size_t size) {
+  ArenaLarge *l = (ArenaLarge *) DohMalloc(sizeof(ArenaLarge) + size);
+  l->header.sclass = ARENA_LARGE;
+  l->prev = 0;
+  l->next = ArenaLargeBlocks;
+  if (ArenaLargeBlocks)
+    ArenaLargeBlocks->prev = l;
+  ArenaLargeBlocks = l;
+  ArenaNumLarge++;
+  return (void *) (l + 1);
+}
+
+static void ArenaLargeUnlink(ArenaLarge *l) {
+  if (l->prev)
+    l->prev->next = l->next;
+  else
+    ArenaLargeBlocks = l->next;
+  if (l->next)
+    l->next->prev = l->prev;
+}
+
+/* ----------------------------------------------------------------------
+ * DohArenaMalloc()
+ *
+ * Allocate a block of object data.
+ * ---------------------------------------------------------------------- */
+
+void *DohArenaMalloc(size_t size) {
+  size_t bsize = size + sizeof(ArenaHeader);
+  ArenaClass *ac;
+  ArenaHeader *h;
+
+  arena_latched = 1;
+  if (!arena_enabled)
+    return DohMalloc(size);
+  if (!arena_initialized)
+    InitArena();
+  if (bsize > ARENA_MAX_BLOCK)
+    return ArenaLargeMalloc(size);
+
+  ac = &ArenaClasses[ArenaClassOf[(bsize + 7) >> 3]];
+  ac->nalloc++;
+  if (ac->freelist) {
+    h = ac->freelist;
+    ac->freelist = *((ArenaHeader **) (h + 1));
+    ac->nreused++;
+  } else {
+    if (ac->bump + ac->size > ac->bumpend)
+      ArenaRefill(ac);
+    h = (ArenaHeader *) ac->bump;
+    ac->bump += ac->size;
+  }
+  h->sclass = (unsigned char) (ac - ArenaClasses);
+  return (void *) (h + 1);
+}
+
+void *DohArenaCalloc(size_t n, size_t size) {
+  void *p = DohArenaMalloc(n * size);
+  memset(p, 0, n * size);
+  return p;
+}
+
+/* ----------------------------------------------------------------------
+ * DohArenaFree()
+ *
+ * Return a block to its size class.
+ * ---------------------------------------------------------------------- */
+
+void DohArenaFree(void *ptr) {
+  ArenaHeader *h;
+  ArenaClass *ac;
+  if (!arena_enabled) {
+    DohFree(ptr);
+    return;
+  }
+  if (!ptr)
+    return;
+  h = ((ArenaHeader *) ptr) - 1;
+  if (h->sclass == ARENA_LARGE) {
+    ArenaLarge *l = ((ArenaLarge *) ptr) - 1;
+    ArenaLargeUnlink(l);
+    ArenaNumLarge--;
+    DohFree(l);
+    return;
+  }
+  ac = &ArenaClasses[h->sclass];
+  *((ArenaHeader **) ptr) = ac->freelist;
+  ac->freelist = h;
+}
+
+/* ----------------------------------------------------------------------
+ * DohArenaRealloc()
+ *
+ * Grow or shrink a block, moving it to another size class if need be.
+ * ---------------------------------------------------------------------- */
+
+void *DohArenaRealloc(void *ptr, size_t size) {
+  ArenaHeader *h;
+  size_t avail;
+  void *np;
+  if (!arena_enabled)
+    return DohRealloc(ptr, size);
+  if (!ptr)
+    return DohArenaMalloc(size);
+  h = ((ArenaHeader *) ptr) - 1;
+  if (h->sclass == ARENA_LARGE) {
+    ArenaLarge *l = ((ArenaLarge *) ptr) - 1;
+    ArenaLarge *nl;
+    ArenaLargeUnlink(l);
+    nl = (ArenaLarge *) DohRealloc(l, sizeof(ArenaLarge) + size);
+    nl->prev = 0;
+    nl->next = ArenaLargeBlocks;
+    if (ArenaLargeBlocks)
+      ArenaLargeBlocks->prev = nl;
+    ArenaLargeBlocks = nl;
+    return (void *) (nl + 1);
+  }
+  avail = ArenaClasses[h->sclass].size - sizeof(ArenaHeader);
+  if (size <= avail)
+    return ptr;
+  np = DohArenaMalloc(size);
+  memcpy(np, ptr, avail);
+  DohArenaFree(ptr);
+  return np;
+}
+
+/* ----------------------------------------------------------------------
+ * DohArenaRelease()
+ *
+ * Release all arena memory at once.  Any DOH object still referring to object
+ * data must not be used afterwards, so this is only for use at exit.
+ * ---------------------------------------------------------------------- */
+
+void DohArenaRelease(void) {
+  int i;
+  if (!arena_enabled)
+    return;
+  while (ArenaChunks) {
+    ArenaChunk *next = ArenaChunks->next;
+    DohFree(ArenaChunks);
+    ArenaChunks = next;
+  }
+  while (ArenaLargeBlocks) {
+    ArenaLarge *next = ArenaLargeBlocks->next;
+    DohFree(ArenaLargeBlocks);
+    ArenaLargeBlocks = next;
+  }
+  for (i = 0; i < ARENA_NCLASSES; i++) {
+    ArenaClasses[i].bump = 0;
+    ArenaClasses[i].bumpend = 0;
+    ArenaClasses[i].freelist = 0;
+  }
+  ArenaNumChunks = 0;
+  ArenaNumLarge = 0;
+}
+
 /* Function to call instead of exit(). */
 static void (*doh_exit_handler)(int) = NULL;
 
@@ -0,0 +1,494 @@
+/* -----------------------------------------------------------------------------
+ * This file is part of SWIG, which is licensed as a whole under version 3
+ * (or any later version) of the GNU General Public License. Some additional
+ * terms also apply to certain portions of SWIG. The full details of the SWIG
+ * license and copyrights can be found in the LICENSE and COPYRIGHT files
+ * included with the SWIG source code as distributed by the SWIG developers
+ * and at https://www.swig.org/legal.html.
+ *
+ * rope.c
+ *
+ *     Implements a write-only, segmented output buffer.  Output is appended to
+ *     a list of fixed size chunks rather than to a single contiguous block, so
+ *     appending never moves data already written.  Chunks are reference
+ *     counted and shared when one rope is dumped into another, and are written
+ *     to files with writev().  A rope can also move the bulk of its contents to
+ *     a temporary file (RopeSpill) or forward it to its final destination as it
+ *     is written (RopeStream), so large generated sections need not be held in
+ *     memory in full.
+ * ----------------------------------------------------------------------------- */
+
+#include "dohint.h"
+
+#ifndef _WIN32
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#define ROPE_CHUNK_SIZE 65536
+#define ROPE_IOV_MAX 64
+#define ROPE_SHARE_MIN (ROPE_CHUNK_SIZE / 4)
+
+typedef struct RopeChunk {
+  int refcount;
+  int len;
+  int size;
+  char data[1];
+} RopeChunk;
+
+typedef struct Rope {
+  RopeChunk **chunks;		/* Chunks in memory, in order */
+  int nchunks;
+  int maxchunks;
+  int len;			/* Total length, including spilled data */
+  int memlen;			/* Length of the chunks in memory */
+  FILE *spill;			/* Temporary file holding the start of the contents */
+  int spilled;			/* Number of bytes in spill */
+  int spill_threshold;		/* Spill when more than this is in memory, 0 never */
+  DOH *stream;			/* Destination full chunks are forwarded to */
+  DOH *flat;			/* Contiguous copy of the contents for Data() */
+} Rope;
+
+/* -----------------------------------------------------------------------------
+ * Chunk management
+ * ----------------------------------------------------------------------------- */
+
+static RopeChunk *chunk_new(int size) {
+  RopeChunk *c = (RopeChunk *) DohMalloc(sizeof(RopeChunk) + size);
+  c->refcount = 1;
+  c->len = 0;
+  c->size = size;
+  return c;
+}
+
+static void chunk_release(RopeChunk *c) {
+  if (--c->refcount == 0)
+    DohFree(c);
+}
+
+static void rope_push(Rope *r, RopeChunk *c) {
+  if (r->nchunks == r->maxchunks) {
+    r->maxchunks = r->maxchunks ? 2 * r->maxchunks : 16;
+    r->chunks = (RopeChunk **) DohRealloc(r->chunks, r->maxchunks * sizeof(RopeChunk *));
+  }
+  r->chunks[r->nchunks++] = c;
+  r->memlen += c->len;
+}
+
+/* Releases the first n chunks */
+static void rope_drop(Rope *r, int n) {
+  int i;
+  for (i = 0; i < n; i++) {
+    r->memlen -= r->chunks[i]->len;
+    chunk_release(r->chunks[i]);
+  }
+  r->nchunks -= n;
+  memmove(r->chunks, r->chunks + n, r->nchunks * sizeof(RopeChunk *));
+}
+
+static void rope_changed(Rope *r) {
+  if (r->flat) {
+    Delete(r->flat);
+    r->flat = 0;
+  }
+}
+
+/* -----------------------------------------------------------------------------
+ * write_chunks()
+ *
+ * Writes chunks to a DOH object.  Files are written directly to their file
+ * descriptor with writev(), other objects with Write().  Returns the number of
+ * bytes written or -1 on error.
+ * ----------------------------------------------------------------------------- */
+
+static int write_chunks(RopeChunk **chunks, int n, DOH *out) {
+  int i, total = 0;
+#ifndef _WIN32
+  int fd = n > 0 ? DohFileDescriptor(out) : -1;
+  if (fd >= 0) {
+    struct iovec iov[ROPE_IOV_MAX];
+    i = 0;
+    while (i < n) {
+      int k = 0;
+      ssize_t want = 0, ret;
+      while (i + k < n && k < ROPE_IOV_MAX) {
+	iov[k].iov_base = chunks[i + k]->data;
+	iov[k].iov_len = chunks[i + k]->len;
+	want += chunks[i + k]->len;
+	k++;
+      }
+      ret = writev(fd, iov, k);
+      if (ret < 0)
+	return -1;
+      if (ret < want) {
+	/* Short write, finish with write() */
+	int j;
+	ssize_t skip = ret;
+	for (j = 0; j < k; j++) {
+	  const char *p = (const char *) iov[j].iov_base;
+	  ssize_t l = (ssize_t) iov[j].iov_len;
+	  if (skip >= l) {
+	    skip -= l;
+	    continue;
+	  }
+	  p += skip;
+	  l -= skip;
+	  skip = 0;
+	  while (l > 0) {
+	    ssize_t w = write(fd, p, l);
+	    if (w < 0)
+	      return -1;
+	    p += w;
+	    l -= w;
+	  }
+	}
+      }
+      total += (int) want;
+      i += k;
+    }
+    DohFileSync(out);
+    return total;
+  }
+#endif
+  for (i = 0; i < n; i++) {
+    int nsent = 0;
+    while (nsent < chunks[i]->len) {
+      int ret = Write(out, chunks[i]->data + nsent, chunks[i]->len - nsent);
+      if (ret < 0)
+	return ret;
+      nsent += ret;
+    }
+    total += nsent;
+  }
+  return total;
+}
+
+/* -----------------------------------------------------------------------------
+ * write_spill()
+ *
+ * Copies the spilled part of the contents to out.
+ * ----------------------------------------------------------------------------- */
+
+static int write_spill(Rope *r, DOH *out) {
+  RopeChunk *buf;
+  int total = 0;
+  if (!r->spilled)
+    return 0;
+  buf = chunk_new(ROPE_CHUNK_SIZE);
+  fflush(r->spill);
+  rewind(r->spill);
+  while (total < r->spilled) {
+    int want = r->spilled - total < buf->size ? r->spilled - total : buf->size;
+    buf->len = (int) fread(buf->data, 1, want, r->spill);
+    if (buf->len <= 0 || write_chunks(&buf, 1, out) < 0) {
+      total = -1;
+      break;
+    }
+    total += buf->len;
+  }
+  fseek(r->spill, 0, SEEK_END);
+  chunk_release(buf);
+  return total;
+}
+
+/* -----------------------------------------------------------------------------
+ * rope_offload()
+ *
+ * Called when a chunk has been filled.  Forwards the full chunks to the stream,
+ * or moves them to the spill file once the memory threshold is exceeded.  The
+ * last chunk stays in memory as it may still be written to.
+ * ----------------------------------------------------------------------------- */
+
+static void rope_offload(Rope *r) {
+  int n = r->nchunks - 1;
+  if (n <= 0)
+    return;
+  if (r->stream) {
+    if (write_chunks(r->chunks, n, r->stream) >= 0) {
+      r->len -= r->memlen - r->chunks[n]->len;
+      rope_drop(r, n);
+    }
+  } else if (r->spill_threshold && r->memlen > r->spill_threshold) {
+    if (!r->spill) {
+      r->spill = tmpfile();
+      if (!r->spill) {
+	r->spill_threshold = 0;
+	return;
+      }
+    }
+    {
+      DOH *f = NewFileFromFile(r->spill);
+      int ret = write_chunks(r->chunks, n, f);
+      Delete(f);
+      if (ret >= 0) {
+	r->spilled += ret;
+	rope_drop(r, n);
+      }
+    }
+  }
+}
+
+/* -----------------------------------------------------------------------------
+ * Rope_write()
+ * ----------------------------------------------------------------------------- */
+
+static int Rope_write(DOH *ro, const void *buffer, int len) {
+  Rope *r = (Rope *) ObjData(ro);
+  const char *p = (const char *) buffer;
+  int left = len;
+  RopeChunk *t = r->nchunks ? r->chunks[r->nchunks - 1] : 0;
+  if (t && t->refcount == 1 && t->size - t->len >= len && !r->flat) {
+    memcpy(t->data + t->len, buffer, len);
+    t->len += len;
+    r->memlen += len;
+    r->len += len;
+    return len;
+  }
+  rope_changed(r);
+  while (left > 0) {
+    RopeChunk *c = r->nchunks ? r->chunks[r->nchunks - 1] : 0;
+    int n;
+    if (!c || c->refcount > 1 || c->len == c->size) {
+      if (c)
+	rope_offload(r);
+      rope_push(r, chunk_new(ROPE_CHUNK_SIZE));
+      c = r->chunks[r->nchunks - 1];
+    }
+    n = c->size - c->len < left ? c->size - c->len : left;
+    memcpy(c->data + c->len, p, n);
+    c->len += n;
+    r->memlen += n;
+    r->len += n;
+    p += n;
+    left -= n;
+  }
+  return len;
+}
+
+/* -----------------------------------------------------------------------------
+ * Rope_putc()
+ * ----------------------------------------------------------------------------- */
+
+static int Rope_putc(DOH *ro, int ch) {
+  Rope *r = (Rope *) ObjData(ro);
+  RopeChunk *c = r->nchunks ? r->chunks[r->nchunks - 1] : 0;
+  if (c && c->refcount == 1 && c->len < c->size && !r->flat) {
+    c->data[c->len++] = (char) ch;
+    r->memlen++;
+    r->len++;
+    return ch;
+  } else {
+    char cc = (char) ch;
+    Rope_write(ro, &cc, 1);
+    return ch;
+  }
+}
+
+/* -----------------------------------------------------------------------------
+ * Rope_tell()
+ * ----------------------------------------------------------------------------- */
+
+static long Rope_tell(DOH *ro) {
+  Rope *r = (Rope *) ObjData(ro);
+  return r->len;
+}
+
+/* -----------------------------------------------------------------------------
+ * Rope_dump()
+ *
+ * Writes the contents to out.  If out is also a rope, the chunks are shared
+ * rather than copied.
+ * ----------------------------------------------------------------------------- */
+
+static int Rope_dump(DOH *ro, DOH *out) {
+  Rope *r = (Rope *) ObjData(ro);
+  int spilled = write_spill(r, out);
+  int ret;
+  if (spilled < 0)
+    return -1;
+  if (DohCheck(out) && ObjType(out) == ObjType(ro) && out != ro) {
+    Rope *o = (Rope *) ObjData(out);
+    int i;
+    rope_changed(o);
+    for (i = 0; i < r->nchunks; i++) {
+      RopeChunk *c = r->chunks[i];
+      if (c->len < ROPE_SHARE_MIN) {
+	/* Not worth sharing a mostly empty chunk */
+	Rope_write(out, c->data, c->len);
+	continue;
+      }
+      c->refcount++;
+      rope_push(o, c);
+      o->len += c->len;
+      rope_offload(o);
+    }
+    return spilled + r->memlen;
+  }
+  ret = write_chunks(r->chunks, r->nchunks, out);
+  return ret < 0 ? ret : spilled + ret;
+}
+
+/* -----------------------------------------------------------------------------
+ * Rope_len()
+ * ----------------------------------------------------------------------------- */
+
+static int Rope_len(DOH *ro) {
+  Rope *r = (Rope *) ObjData(ro);
+  return r->len;
+}
+
+/* -----------------------------------------------------------------------------
+ * Rope_str()
+ *
+ * Returns the contents as a new String.
+ * ----------------------------------------------------------------------------- */
+
+static DOH *Rope_str(DOH *ro) {
+  DOH *s = NewStringEmpty();
+  Rope_dump(ro, s);
+  return s;
+}
+
+/* -----------------------------------------------------------------------------
+ * Rope_data()
+ *
+ * Returns the contents as a contiguous block, which is only valid until the
+ * rope is next written to.
+ * ----------------------------------------------------------------------------- */
+
+static void *Rope_data(DOH *ro) {
+  Rope *r = (Rope *) ObjData(ro);
+  if (!r->flat)
+    r->flat = Rope_str(ro);
+  return Data(r->flat);
+}
+
+/* -----------------------------------------------------------------------------
+ * Rope_clear()
+ * ----------------------------------------------------------------------------- */
+
+static void Rope_clear(DOH *ro) {
+  Rope *r = (Rope *) ObjData(ro);
+  rope_changed(r);
+  rope_drop(r, r->nchunks);
+  if (r->spill) {
+    fclose(r->spill);
+    r->spill = 0;
+  }
+  r->spilled = 0;
+  r->len = 0;
+}
+
+/* -----------------------------------------------------------------------------
+ * CopyRope()
+ * ----------------------------------------------------------------------------- */
+
+static DOH *CopyRope(DOH *ro) {
+  DOH *c = DohNewRope();
+  Rope_dump(ro, c);
+  return c;
+}
+
+/* -----------------------------------------------------------------------------
+ * DelRope()
+ * ----------------------------------------------------------------------------- */
+
+static void DelRope(DOH *ro) {
+  Rope *r = (Rope *) ObjData(ro);
+  Rope_clear(ro);
+  Delete(r->stream);
+  DohFree(r->chunks);
+  DohFree(r);
+}
+
+static DohFileMethods RopeFileMethods = {
+  0,				/* doh_read     */
+  Rope_write,			/* doh_write    */
+  Rope_putc,			/* doh_putc     */
+  0,				/* doh_getc     */
+  0,				/* doh_ungetc   */
+  0,				/* doh_seek     */
+  Rope_tell,			/* doh_tell     */
+};
+
+static DohObjInfo DohRopeType = {
+  "Rope",			/* objname      */
+  DelRope,			/* doh_del      */
+  CopyRope,			/* doh_copy     */
+  Rope_clear,			/* doh_clear    */
+  Rope_str,			/* doh_str      */
+  Rope_data,			/* doh_data     */
+  Rope_dump,			/* doh_dump     */
+  Rope_len,			/* doh_len      */
+  0,				/* doh_hash     */
+  0,				/* doh_cmp      */
+  0,				/* doh_equal    */
+  0,				/* doh_first    */
+  0,				/* doh_next     */
+  0,				/* doh_setfile  */
+  0,				/* doh_getfile  */
+  0,				/* doh_setline  */
+  0,				/* doh_getline  */
+  0,				/* doh_mapping  */
+  0,				/* doh_sequence */
+  &RopeFileMethods,		/* doh_file     */
+  0,				/* doh_string   */
+  0,				/* doh_callable */
+  0,				/* doh_position */
+};
+
+/* -----------------------------------------------------------------------------
+ * NewRope()
+ *
+ * Create a new, empty rope.
+ * ----------------------------------------------------------------------------- */
+
+DOH *DohNewRope(void) {
+  Rope *r = (Rope *) DohMalloc(sizeof(Rope));
+  r->chunks = 0;
+  r->nchunks = 0;
+  r->maxchunks = 0;
+  r->len = 0;
+  r->memlen = 0;
+  r->spill = 0;
+  r->spilled = 0;
+  r->spill_threshold = 0;
+  r->stream = 0;
+  r->flat = 0;
+  return DohObjMalloc(&DohRopeType, r);
+}
+
+/* -----------------------------------------------------------------------------
+ * RopeSpill()
+ *
+ * Once more than threshold bytes are held in memory, move the completed chunks
+ * of the rope to a temporary file.  They are copied back out when the rope is
+ * dumped.  A threshold of 0 keeps everything in memory.
+ * ----------------------------------------------------------------------------- */
+
+void DohRopeSpill(DOH *ro, int threshold) {
+  Rope *r = (Rope *) ObjData(ro);
+  assert(ObjType(ro) == &DohRopeType);
+  r->spill_threshold = threshold;
+}
+
+/* -----------------------------------------------------------------------------
+ * RopeStream()
+ *
+ * Writes the contents of the rope to out and from then on forwards each chunk
+ * to out as soon as it is full.  Afterwards the rope only holds the output not
+ * yet written to out, which a final Dump() to out completes.  Only to be used
+ * once nothing else will be written to out ahead of the rope's contents.
+ * ----------------------------------------------------------------------------- */
+
+int DohRopeStream(DOH *ro, DOH *out) {
+  Rope *r = (Rope *) ObjData(ro);
+  int ret;
+  assert(ObjType(ro) == &DohRopeType);
+  ret = Rope_dump(ro, out);
+  Rope_clear(ro);
+  Incref(out);
+  Delete(r->stream);
+  r->stream = out;
+  return ret;
+}
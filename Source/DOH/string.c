@@ -66,14 +66,14 @@ static int String_dump(DOH *so, DOH *out) {
 static DOH *CopyString(DOH *so) {
   String *str;
   String *s = (String *) ObjData(so);
-  str = (String *) DohMalloc(sizeof(String));
+  str = (String *) DohArenaMalloc(sizeof(String));
   str->hashkey = s->hashkey;
   str->sp = s->sp;
   str->line = s->line;
   str->file = s->file;
   if (str->file)
     Incref(str->file);
-  str->str = (char *) DohMalloc(s->len + 1);
+  str->str = (char *) DohArenaMalloc(s->len + 1);
   memcpy(str->str, s->str, s->len);
   str->maxsize = s->len;
   str->len = s->len;
@@ -88,8 +88,8 @@ static DOH *CopyString(DOH *so) {
 
 static void DelString(DOH *so) {
   String *s = (String *) ObjData(so);
-  DohFree(s->str);
-  DohFree(s);
+  DohArenaFree(s->str);
+  DohArenaFree(s);
 }
 
 /* -----------------------------------------------------------------------------
@@ -236,7 +236,7 @@ static void DohString_append(DOH *so, const DOHString_or_char *str) {
     newmaxsize = 2 * s->maxsize;
     if (newlen >= newmaxsize - 1)
       newmaxsize = newlen + 1;
-    s->str = (char *) DohRealloc(s->str, newmaxsize);
+    s->str = (char *) DohArenaRealloc(s->str, newmaxsize);
     s->maxsize = newmaxsize;
   }
   tc = s->str;
@@ -302,7 +302,7 @@ static int String_insert(DOH *so, int pos, DOH *str) {
   /* See if there is room to insert the new data */
   while (s->maxsize <= s->len + len) {
     int newsize = 2 * s->maxsize;
-    s->str = (char *) DohRealloc(s->str, newsize);
+    s->str = (char *) DohArenaRealloc(s->str, newsize);
     s->maxsize = newsize;
   }
   memmove(s->str + pos + len, s->str + pos, (s->len - pos));
@@ -429,7 +429,7 @@ static int String_write(DOH *so, const void *buffer, int len) {
     s->sp = s->len;
   newlen = s->sp + len + 1;
   if (newlen > s->maxsize) {
-    s->str = (char *) DohRealloc(s->str, newlen);
+    s->str = (char *) DohArenaRealloc(s->str, newlen);
     s->maxsize = newlen;
     s->len = s->sp + len;
   }
@@ -521,7 +521,7 @@ static int String_putc(DOH *so, int ch) {
     char *tc = s->str;
     if (len > (maxsize - 2)) {
       maxsize *= 2;
-      tc = (char *) DohRealloc(tc, maxsize);
+      tc = (char *) DohArenaRealloc(tc, maxsize);
       s->maxsize = (int) maxsize;
       s->str = tc;
     }
@@ -932,7 +932,7 @@ static int replace_simple(String *str, char *token, char *rep, int flags, int co
     while ((str->len + expand) >= newsize)
       newsize *= 2;
 
-    ns = (char *) DohMalloc(newsize);
+    ns = (char *) DohArenaMalloc(newsize);
     t = ns;
     s = first;
 
@@ -1007,7 +1007,7 @@ static int replace_simple(String *str, char *token, char *rep, int flags, int co
     str->len += expand;
     str->str[str->len] = 0;
     str->maxsize = newsize;
-    DohFree(c);
+    DohArenaFree(c);
     return rcount;
   }
 }
@@ -1159,7 +1159,7 @@ DOHString *DohNewString(const DOHString_or_char *so) {
     l = s ? (int) strlen(s) : 0;
   }
 
-  str = (String *) DohMalloc(sizeof(String));
+  str = (String *) DohArenaMalloc(sizeof(String));
   str->hashkey = hashkey;
   str->sp = 0;
   str->line = 1;
@@ -1169,7 +1169,7 @@ DOHString *DohNewString(const DOHString_or_char *so) {
     if ((l + 1) > max)
       max = l + 1;
   }
-  str->str = (char *) DohMalloc(max);
+  str->str = (char *) DohArenaMalloc(max);
   str->maxsize = max;
   if (s) {
     strcpy(str->str, s);
@@ -1189,12 +1189,12 @@ DOHString *DohNewString(const DOHString_or_char *so) {
 
 DOHString *DohNewStringEmpty(void) {
   int max = INIT_MAXSIZE;
-  String *str = (String *) DohMalloc(sizeof(String));
+  String *str = (String *) DohArenaMalloc(sizeof(String));
   str->hashkey = 0;
   str->sp = 0;
   str->line = 1;
   str->file = 0;
-  str->str = (char *) DohMalloc(max);
+  str->str = (char *) DohArenaMalloc(max);
   str->maxsize = max;
   str->str[0] = 0;
   str->len = 0;
@@ -1215,7 +1215,7 @@ DOHString *DohNewStringWithSize(const DOHString_or_char *so, int len) {
     s = (char *) so;
   }
 
-  str = (String *) DohMalloc(sizeof(String));
+  str = (String *) DohArenaMalloc(sizeof(String));
   str->hashkey = -1;
   str->sp = 0;
   str->line = 1;
@@ -1226,7 +1226,7 @@ DOHString *DohNewStringWithSize(const DOHString_or_char *so, int len) {
     if ((l + 1) > max)
       max = l + 1;
   }
-  str->str = (char *) DohMalloc(max);
+  str->str = (char *) DohArenaMalloc(max);
   str->maxsize = max;
   if (s) {
     strncpy(str->str, s, len);
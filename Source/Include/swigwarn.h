@@ -308,6 +308,10 @@
 
 /* 850-860 were used by Modula 3 (removed in SWIG 4.1.0) - avoid reusing for now */
 
+#define WARN_JS_CACHE_IGNORED                 861
+
+/* please leave 861-869 free for JavaScript */
+
 #define WARN_PHP_MULTIPLE_INHERITANCE         870
 #define WARN_PHP_UNKNOWN_PRAGMA               871
 #define WARN_PHP_PUBLIC_BASE                  872
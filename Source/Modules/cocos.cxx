@@ -18,6 +18,14 @@
 #include <string>
 #include <stack>
 #include <sstream>
+#include <map>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 namespace cc {
 
@@ -26,6 +34,45 @@ namespace cc {
  */
 static bool js_template_enable_debug = false;
 
+/**
+ * Number of processes used to emit classes (-j<n>).
+ */
+static int js_parallel_jobs = 1;
+
+/**
+ * Registers classes on first access through accessors on the namespace (-defer-classes).
+ */
+static bool js_lazy_classes = false;
+
+/**
+ * Converts primitive arguments and results inline (-fastcall).
+ */
+static bool js_fastcall = false;
+
+/**
+ * Largest number of script arguments of a -fastcall wrapper.
+ */
+#define FASTCALL_MAX_ARGS 4
+
+/**
+ * Output sections holding more than this many bytes in memory move their
+ * completed parts to a temporary file.
+ */
+#define SECTION_SPILL_THRESHOLD (8 * 1024 * 1024)
+
+/**
+ * Creates the buffer of an output section. Serial runs use ropes, which do not
+ * copy on growth and spill to disk once large. Parallel runs (-j) use Strings,
+ * the ParallelEmitter splices the sections by offset.
+ */
+static String *newSection() {
+    if (js_parallel_jobs > 1)
+        return NewString("");
+    String *s = NewRope();
+    RopeSpill(s, SECTION_SPILL_THRESHOLD);
+    return s;
+}
+
 #define ERR_MSG_ONLY_ONE_ENGINE_PLEASE "Only one engine can be specified at a time."
 
 // keywords used for state variables
@@ -34,6 +81,7 @@ static bool js_template_enable_debug = false;
 #define TYPE "type"
 #define TYPE_MANGLED "type_mangled"
 #define WRAPPER_NAME "wrapper"
+#define BATCH_WRAPPER_NAME "batch_wrapper"
 #define IS_IMMUTABLE "is_immutable"
 #define IS_WRITE_ONLY "is_write_only"
 #define IS_STATIC "is_static"
@@ -44,7 +92,6 @@ static bool js_template_enable_debug = false;
 #define PARENT_MANGLED "parent_mangled"
 #define CTOR "ctor"
 #define CTOR_WRAPPERS "ctor_wrappers"
-#define CTOR_DISPATCHERS "ctor_dispatchers"
 #define DTOR "dtor"
 #define ARGCOUNT "wrap:argc"
 #define HAS_TEMPLATES "has_templates"
@@ -237,6 +284,138 @@ static void convertToMangledName(String* name) {
     Replaceall(name, "*", "_");
 }
 
+/**
+ * Tests whether a class found by Language::classLookup is registered by this
+ * module. Imported classes, classes which are not accessible and classes in
+ * ignored classes are not.
+ */
+static bool isWrappedClass(Node *n) {
+    if (!Getattr(n, "sym:name") || Equal(Getattr(n, "access"), "private") || Equal(Getattr(n, "access"), "protected")) {
+        return false;
+    }
+    for (Node *outer = Getattr(n, "nested:outer"); outer; outer = Getattr(outer, "nested:outer")) {
+        if (GetFlag(outer, "feature:ignore") || !Getattr(outer, "sym:name")) {
+            return false;
+        }
+    }
+    for (Node *parent = parentNode(n); parent; parent = parentNode(parent)) {
+        if (Equal(nodeType(parent), "import")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Tests whether values of type are converted to an immutable script value,
+ * a number, boolean or string, which can be cached outside the script engine.
+ */
+static bool isImmutableScriptValue(SwigType *type) {
+    static const char *names[] = {
+        "bool", "char", "signed char", "unsigned char", "short", "unsigned short", "int", "unsigned int",
+        "long", "unsigned long", "long long", "unsigned long long", "float", "double",
+        "std::string", "ccstd::string", 0
+    };
+    SwigType *resolved = SwigType_typedef_resolve_all(type);
+    if (SwigType_isreference(resolved)) {
+        SwigType_del_reference(resolved);
+    }
+    SwigType *t = SwigType_strip_qualifiers(resolved);
+    bool immutable = false;
+    if (SwigType_isenum(t)) {
+        immutable = true;
+    } else if (SwigType_ispointer(t)) {
+        SwigType_del_pointer(t);
+        SwigType *pointee = SwigType_strip_qualifiers(t);
+        immutable = Equal(pointee, "char");
+        Delete(pointee);
+    } else if (SwigType_issimple(t)) {
+        for (int i = 0; names[i] && !immutable; i++) {
+            immutable = Equal(t, names[i]);
+        }
+    }
+    Delete(t);
+    Delete(resolved);
+    return immutable;
+}
+
+/**
+ * Tests whether the value of a member variable is cached, %feature("js:cache").
+ * type is the type of the member. Only members of instances converted to
+ * immutable script values are cached:
+ * a cached script object would have to be kept alive by the cache, or could
+ * be changed by the script, which a later read would see.
+ */
+static bool isCachedMember(Node *n, SwigType *type, bool is_member, bool is_static, bool warn) {
+    if (!GetFlag(n, "feature:js:cache") || !is_member || is_static) {
+        return false;
+    }
+    if (!type || !isImmutableScriptValue(type)) {
+        if (warn) {
+            Swig_warning(WARN_JS_CACHE_IGNORED, input_file, line_number,
+                         "%%feature(\"js:cache\") ignored for %s, only numbers, booleans and strings are cached.\n", Getattr(n, "name"));
+        }
+        return false;
+    }
+    String *fragment = NewString("js_cache");
+    Swig_fragment_emit(fragment);
+    Delete(fragment);
+    return true;
+}
+
+/**
+ * Counts the members of a class with %feature("js:cache"), not including
+ * inherited members. Members the feature is ignored for are counted too.
+ */
+static int cachedMemberCount(Node *n) {
+    int count = 0;
+    for (Node *c = firstChild(n); c; c = nextSibling(c)) {
+        if (GetFlag(c, "feature:js:cache")) {
+            count++;
+        } else if (Equal(nodeType(c), "extend")) {
+            count += cachedMemberCount(c);
+        }
+    }
+    return count;
+}
+
+/**
+ * Tests whether any member of a class or of its base classes has %feature("js:cache").
+ */
+static bool hasCachedMembers(Node *n) {
+    if (cachedMemberCount(n)) {
+        return true;
+    }
+    for (Iterator b = First(Getattr(n, "bases")); b.item; b = Next(b)) {
+        if (hasCachedMembers(b.item)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Returns the class of the result of n if it is returned by value and has
+ * %feature("js:pool"), unless a user out typemap converts it.
+ */
+static Node *pooledResultClass(Node *n) {
+    SwigType *type = Getattr(n, "type");
+    if (!type || Getattr(n, "feature:release_returned_cpp_object_in_gc")) {
+        return NULL;
+    }
+    SwigType *resolved = SwigType_typedef_resolve_all(type);
+    SwigType *stripped = SwigType_strip_qualifiers(resolved);
+    bool by_value = !SwigType_ispointer(stripped) && !SwigType_isreference(stripped) && !SwigType_isrvalue_reference(stripped) && !SwigType_isarray(stripped);
+    Delete(stripped);
+    Delete(resolved);
+    Node *classNode = by_value ? Language::classLookup(type) : NULL;
+    if (!classNode || !Getattr(classNode, "feature:js:pool")) {
+        return NULL;
+    }
+    Swig_typemap_lookup("out", n, "", 0);
+    return GetFlag(n, "tmap:out:fast") ? classNode : NULL;
+}
+
 static int getParamListCount(ParmList* params) {
     int count = 0;
     ParmList* p = params;
@@ -381,6 +560,125 @@ private:
     String *templateName;
 };
 
+/**
+ * Emits top level classes in forked worker processes (-j<n>).
+ *
+ * Every process walks the whole parse tree, so that directives, typemaps and
+ * fragments are seen in the same order as in a serial run, but a top level
+ * class (a unit) is only emitted by the process owning it. The output of a
+ * unit in the tracked streams, stdout and stderr is sent back to the parent,
+ * which splices it into its own output in unit order. Fragments are emitted
+ * with markers so that the copies emitted by several processes reduce to the
+ * one a serial run emits.
+ */
+class ParallelEmitter {
+public:
+    ParallelEmitter(int jobs);
+    ~ParallelEmitter();
+
+    /**
+   * Tracks the output DOH registered for a section, e.g. "wrapper".
+   */
+    void trackSection(const char *section);
+
+    /**
+   * Tracks an output String.
+   */
+    void track(String *stream);
+
+    /**
+   * Assigns the top level classes to processes. Classes depending on each
+   * other's emission, i.e. related by inheritance, smart pointers or
+   * overloads, are emitted by the same process. Classes containing typemap
+   * related directives change the state seen by later classes and are
+   * emitted by all processes.
+   */
+    void partition(Node *top);
+
+    /**
+   * Forks the worker processes.
+   * Returns false if emission has to stay serial.
+   */
+    bool start();
+
+    /**
+   * Invoked at the beginning of a top level class.
+   * Returns true if this process emits the class.
+   */
+    bool enterUnit(Node *n);
+
+    /**
+   * Invoked at the end of a top level class emitted by this process.
+   */
+    void exitUnit();
+
+    /**
+   * Workers report their output and exit, the parent merges it.
+   */
+    void finish();
+
+private:
+    struct Unit {
+        int owner;
+        // positions in the streams and captured stdout/stderr of this process
+        std::vector<int> start;
+        std::vector<int> end;
+        long out_start, out_end, err_start, err_end;
+        // output reported by the owning worker
+        std::vector<std::string> output;
+        long wout_start, wout_end, werr_start, werr_end;
+    };
+
+    struct Worker {
+        FILE *result;
+        FILE *out;
+        FILE *err;
+        int pid;
+        int status;
+        int errors;
+        int pending;
+        long pending_out, pending_err;
+        bool ok;
+    };
+
+    void collectClasses(Node *n, int outer);
+    int classOf(Node *n) const;
+    int findGroup(int i);
+    void joinGroups(int i, int j);
+    void readResults(Worker &w);
+    std::string mergeCapture(bool is_out, int upto) const;
+    void restoreOutput();
+    static std::string readRange(FILE *f, long from, long to);
+    static void copyCapture(FILE *f, int fd);
+    static void workerExit(int status);
+    static void parentExit();
+    static void parentSignal(int sig);
+
+    int jobs;
+    int worker;
+    bool active;
+    bool reporting;
+    int errors;
+    int saved_out, saved_err;
+    FILE *out, *err;
+    std::vector<const char *> sections;
+    std::vector<String *> streams;
+    std::vector<const char *> stream_sections;
+    std::vector<File *> files;
+    std::vector<Unit> units;
+    std::vector<Worker> workers;
+
+    // top level classes, index 0 stands for everything outside of classes
+    std::map<Node *, int> classIndex;
+    std::vector<Node *> classes;
+    std::vector<int> groups;
+    std::vector<bool> shared;
+    std::vector<std::pair<int, Node *> > overloaded;
+    std::map<Node *, int> owners;
+
+    static ParallelEmitter *instance;
+};
+
 /**
  * JSEmitter represents an abstraction of javascript code generators
  * for different javascript engines.
@@ -393,7 +691,8 @@ protected:
         Setter,
         Getter,
         Ctor,
-        Function
+        Function,
+        Batch
     };
 
 public:
@@ -497,6 +796,11 @@ public:
     void pushState();
     void popState();
 
+    /**
+   * Registers the output DOHs written by classes with the parallel emitter.
+   */
+    virtual void trackParallelStreams(ParallelEmitter &parallel);
+
 protected:
     /**
    * Generates code for a constructor function.
@@ -515,6 +819,28 @@ protected:
 
     virtual int emitFunctionDispatcher(Node *n, bool /*is_member */);
 
+    /**
+   * Generates the batch wrapper of a method, %feature("js:batch").
+   */
+    virtual int emitBatchFunction(Node *n, String *wrap_name, bool is_member, bool is_static);
+
+    /**
+   * Appends the cases dispatching to the overloads of a function or ctor.
+   */
+    void emitDispatchCases(Node *n, const char *dispatch_case, const char *typecheck_case, String *out);
+
+    String *emitTypecheck(Node *n, bool loose);
+
+    /**
+   * Returns the index of the cache slot of a member of the current class, %feature("js:cache").
+   */
+    String *cacheSlot(Node *n, String *name);
+
+    /**
+   * Tests whether a wrapper can use the in_fast and out_fast typemaps (-fastcall).
+   */
+    bool useFastCall(Node *n, ParmList *parms, bool has_this, bool has_result);
+
     /**
    * Generates code for a getter function.
    */
@@ -571,9 +897,10 @@ JSEmitter *swig_javascript_create_CocosEmitter();
 
 class COCOS : public Language {
 public:
-    COCOS() : emitter(NULL) {
+    COCOS() : emitter(NULL), parallel(NULL), classDepth(0) {
     }
     ~COCOS() {
+        delete parallel;
         delete emitter;
     }
 
@@ -622,6 +949,8 @@ public:
 
 private:
     JSEmitter *emitter;
+    ParallelEmitter *parallel;
+    int classDepth;
 };
 
 /* ---------------------------------------------------------------------
@@ -775,9 +1104,20 @@ int COCOS::nativeWrapper(Node *n) {
 int COCOS::classHandler(Node *n) {
     emitter->switchNamespace(n);
 
+    // with -j<n> top level classes are emitted by one of the processes only
+    if (parallel && classDepth == 0 && !parallel->enterUnit(n)) {
+        return SWIG_OK;
+    }
+
+    classDepth++;
     emitter->enterClass(n);
     Language::classHandler(n);
     emitter->exitClass(n);
+    classDepth--;
+
+    if (parallel && classDepth == 0) {
+        parallel->exitUnit();
+    }
 
     return SWIG_OK;
 }
@@ -863,8 +1203,24 @@ String *COCOS::getNSpace() const {
 int COCOS::top(Node *n) {
     emitter->initialize(n);
 
+    if (js_parallel_jobs > 1) {
+        parallel = new ParallelEmitter(js_parallel_jobs);
+        emitter->trackParallelStreams(*parallel);
+        parallel->partition(n);
+        if (!parallel->start()) {
+            delete parallel;
+            parallel = NULL;
+        }
+    }
+
     Language::top(n);
 
+    if (parallel) {
+        parallel->finish();
+        delete parallel;
+        parallel = NULL;
+    }
+
     emitter->dump(n);
     emitter->close();
 
@@ -874,7 +1230,11 @@ int COCOS::top(Node *n) {
 static const char *usage = (char *)
     "\
 Javascript Options (available with -cocos)\n\
-     -debug-codetemplates   - generates information about the origin of code templates\n";
+     -debug-codetemplates   - generates information about the origin of code templates\n\
+     -defer-classes         - register classes on first access instead of at module init, native code must\n\
+                              read a class from its namespace before passing its objects to script\n\
+     -fastcall              - convert primitive arguments and results of small functions inline\n\
+     -j<n>                  - emit classes using <n> processes, the output is the same as a serial run\n";
 
 /* ---------------------------------------------------------------------
  * main()
@@ -893,6 +1253,20 @@ void COCOS::main(int argc, char *argv[]) {
             if (strcmp(argv[i], "-debug-codetemplates") == 0) {
                 Swig_mark_arg(i);
                 js_template_enable_debug = true;
+            } else if (strcmp(argv[i], "-defer-classes") == 0) {
+                Swig_mark_arg(i);
+                js_lazy_classes = true;
+            } else if (strcmp(argv[i], "-fastcall") == 0) {
+                Swig_mark_arg(i);
+                js_fastcall = true;
+            } else if (strncmp(argv[i], "-j", 2) == 0 && argv[i][2]) {
+                const char *jobs = argv[i] + 2;
+                if (strspn(jobs, "0123456789") != strlen(jobs) || atoi(jobs) < 1) {
+                    Printf(stderr, "Invalid number of jobs '%s'.\n", jobs);
+                    Exit(EXIT_FAILURE);
+                }
+                Swig_mark_arg(i);
+                js_parallel_jobs = atoi(jobs);
             } else if (strcmp(argv[i], "-help") == 0) {
                 fputs(usage, stdout);
                 return;
@@ -916,6 +1290,10 @@ void COCOS::main(int argc, char *argv[]) {
 
     // Add a symbol to the parser for conditional compilation
     Preprocessor_define("SWIGCOCOS 1", 0);
+    if (js_lazy_classes)
+        Preprocessor_define("SWIG_COCOS_LAZY_CLASSES 1", 0);
+    if (js_fastcall)
+        Preprocessor_define("SWIG_COCOS_FASTCALL 1", 0);
 
     // Add typemap definitions
     SWIG_typemap_lang("javascript");
@@ -997,7 +1375,7 @@ int JSEmitter::initialize(Node * /*n */) {
     Setattr(namespaces, "::", global_namespace);
     current_namespace = global_namespace;
 
-    s_wrappers = NewString("");
+    s_wrappers = newSection();
 
     return SWIG_OK;
 }
@@ -1133,8 +1511,6 @@ int JSEmitter::enterClass(Node *n) {
     state.clazz(CTOR, ctorStr);
     Delete(ctorStr);
 
-    state.clazz(CTOR_DISPATCHERS, NewString(""));
-
     // HACK: assume that a class is abstract
     // this is resolved by emitCtor (which is only called for non abstract classes)
     SetFlag(state.clazz(), IS_ABSTRACT);
@@ -1145,11 +1521,30 @@ int JSEmitter::enterClass(Node *n) {
     }
 
     /* adds a class registration statement to initializer function */
-    Template t_registerclass(getTemplate("jsc_class_registration"));
+    const char *registration = "jsc_class_registration";
+    String *outer_mangled = NULL;
+    if (js_lazy_classes) {
+        // nested classes are defined on their enclosing class, and registered with it
+        List *nestClassNameList = createNestClassSymNameList(n);
+        if (nestClassNameList && Len(nestClassNameList) > 1) {
+            // the enclosing class may not be declared yet, so it has no classtype
+            outer_mangled = SwigType_namestr(Getattr(Getattr(n, "nested:outer"), "name"));
+            convertToMangledName(outer_mangled);
+            registration = "jsc_nested_class_lazy_registration";
+        } else {
+            registration = "jsc_class_lazy_registration";
+        }
+        Delete(nestClassNameList);
+    }
+    Template t_registerclass(getTemplate(registration));
     t_registerclass.replace("$jsname", state.clazz(NAME))
         .replace("$jsmangledname", state.clazz(NAME_MANGLED))
-        .replace("$jsnspace", Getattr(state.clazz("nspace"), NAME_MANGLED))
-        .pretty_print(_rootState->globals(REGISTER_CLASSES));
+        .replace("$jsnspace", Getattr(state.clazz("nspace"), NAME_MANGLED));
+    if (outer_mangled) {
+        t_registerclass.replace("$jsoutermangledname", outer_mangled);
+        Delete(outer_mangled);
+    }
+    t_registerclass.pretty_print(_rootState->globals(REGISTER_CLASSES));
 
     if (moduleMacro) {
         Printv(_rootState->globals(REGISTER_CLASSES), "#endif // ", moduleMacro, "\n", NIL);
@@ -1219,6 +1614,11 @@ void JSEmitter::popState() {
     _stateStack.pop();
 }
 
+void JSEmitter::trackParallelStreams(ParallelEmitter &parallel) {
+    parallel.track(_rootState->globals(REGISTER_CLASSES));
+    parallel.track(_rootState->globals(HEADER_REGISTER_CLASSES));
+}
+
 int JSEmitter::emitCtor(Node *n) {
     auto& state = currentState();
     Wrapper *wrapper = NewWrapper();
@@ -1251,6 +1651,10 @@ int JSEmitter::emitCtor(Node *n) {
     ParmList *params = Getattr(n, "parms");
     emit_parameter_variables(params, wrapper);
     emit_attach_parmmaps(params, wrapper);
+    if (is_overloaded) {
+        Swig_typemap_attach_parms("typecheck", params, 0);
+        Setattr(n, "wrap:parms", params);
+    }
     // HACK: in test-case `ignore_parameter` emit_attach_parmmaps generated an extra line of applied typemaps.
     // Deleting wrapper->code here, to reset, and as it seemed to have no side effect elsewhere
     Delete(wrapper->code);
@@ -1297,24 +1701,23 @@ s.thisObject()->setPrivateObject(ptr);)";
     Delete(jsCheckArgCountStr);
     jsCheckArgCountStr = nullptr;
 
-    Template t_ctor_case(getTemplate("js_ctor_dispatch_case"));
-    t_ctor_case.replace("$jswrapper", wrap_name)
-        .replace("$jsargcount", argCount);
-    Append(state.clazz(CTOR_DISPATCHERS), t_ctor_case.str());
-
     DelWrapper(wrapper);
 
     Clear(state.clazz(CTOR));
     // create a dispatching ctor
     if (is_overloaded) {
         if (!Getattr(n, "sym:nextSibling")) {
+            String *dispatchCases = NewStringEmpty();
+            emitDispatchCases(n, "js_ctor_dispatch_case", "js_ctor_dispatch_typecheck_case", dispatchCases);
+
             Template t_mainctor(getTemplate("js_ctor_dispatcher"));
             t_mainctor.replace("$jswrapper", wrapNameWithoutOverloadName)
                 .replace("$jsmangledname", state.clazz(NAME_MANGLED))
                 .replace("$jsname", state.clazz(NAME))
                 .replace("$jsdtor", dtorSymName)
-                .replace("$jsdispatchcases", state.clazz(CTOR_DISPATCHERS))
+                .replace("$jsdispatchcases", dispatchCases)
                 .pretty_print(s_wrappers);
+            Delete(dispatchCases);
 
             Printf(state.clazz(CTOR), "_SE(%s)", wrapNameWithoutOverloadName);
         }
@@ -1435,6 +1838,15 @@ int JSEmitter::emitDtor(Node *n) {
      Maybe the fix for the destructor_action always true problem is that this is supposed to be embedded in the if(Extend) block above.
      But I don't fully understand the conditions of any of these things, and since it works for the moment, I don't want to break more stuff.
    */
+    // the cache slots of a collected object are dropped before its address is reused
+    String *cache_release = NewStringEmpty();
+    if (hasCachedMembers(classNode)) {
+        String *fragment = NewString("js_cache");
+        Swig_fragment_emit(fragment);
+        Delete(fragment);
+        Append(cache_release, "js_cache_invalidate(s.thisObject());");
+    }
+
     if (destructor_action) {
         Template t_dtor = getTemplate("js_dtoroverride");
         state.clazz(DTOR, wrap_name);
@@ -1442,7 +1854,8 @@ int JSEmitter::emitDtor(Node *n) {
             .replace("$jswrapper", wrap_name)
             .replace("$jsfree", jsfree)
             .replace("$jsclass_type", classType)
-            .replace("$jstype", ctype);
+            .replace("$jstype", ctype)
+            .replace("$jscacherelease", cache_release);
 
         t_dtor.replace("${destructor_action}", destructor_action);
         Wrapper_pretty_print(t_dtor.str(), s_wrappers);
@@ -1454,9 +1867,11 @@ int JSEmitter::emitDtor(Node *n) {
             .replace("$jsfree", jsfree)
             .replace("$jsclass_type", classType)
             .replace("$jstype", ctype)
+            .replace("$jscacherelease", cache_release)
             .pretty_print(s_wrappers);
     }
 
+    Delete(cache_release);
     Delete(p_classtype);
     Delete(ctype);
     Delete(jsfree);
@@ -1508,8 +1923,10 @@ int JSEmitter::emitGetter(Node *n, bool is_member, bool is_static) {
     int isextendmember = GetFlag(n, "isextendmember");
     int is_global = !is_member && !is_static;
 
+    // %feature("js:cache") keeps the converted value of a member in a slot of its script object
+    bool is_cached = isCachedMember(n, Getattr(n, "type"), is_member, is_static, true);
     Wrapper *wrapper = NewWrapper();
-    Template t_getter(getTemplate("js_getter"));
+    Template t_getter(getTemplate(is_cached ? "js_cached_getter" : "js_getter"));
 
     // prepare wrapper name
     String* wrap_name = getVariableWrapName(n, true);
@@ -1526,6 +1943,7 @@ int JSEmitter::emitGetter(Node *n, bool is_member, bool is_static) {
 
     // prepare code part
     String *action = (isextendmember || is_static || is_global) ? emit_action(n) : NewStringEmpty();
+    useFastCall(n, params, is_member && !is_static, true);
     marshalInputArgs(n, params, wrapper, Getter, is_member, is_static);
     String* prop = (!isextendmember && !is_static && !is_global) ? NewStringf("arg1->%s", Getattr(n, "name")) : nullptr;
 
@@ -1543,6 +1961,11 @@ int JSEmitter::emitGetter(Node *n, bool is_member, bool is_static) {
         Printv(getter_end, "#endif // ", moduleMacro, "\n", NIL);
     }
 
+    if (is_cached) {
+        String *index = cacheSlot(n, state.variable(NAME));
+        t_getter.replace("$jscacheindex", index);
+        Delete(index);
+    }
     t_getter.replace("$jswrapper", wrap_name)
         .replace("$js_getter_begin", getter_begin)
         .replace("$js_getter_end", getter_end)
@@ -1606,10 +2029,18 @@ int JSEmitter::emitSetter(Node *n, bool is_member, bool is_static) {
 
     // prepare code part
     String *action = emit_action(n);
+    useFastCall(n, params, is_member && !is_static, false);
     marshalInputArgs(n, params, wrapper, Setter, is_member, is_static);
     if (isextendmember || value == nullptr) { //cjh added
         Append(wrapper->code, action);
     }
+    if (isCachedMember(n, value ? Getattr(value, "type") : nullptr, is_member, is_static, false)) {
+        String *index = cacheSlot(n, state.variable(NAME));
+        Template t_invalidate(getTemplate("js_cache_invalidation"));
+        t_invalidate.replace("$jscacheindex", index)
+            .print(wrapper->code);
+        Delete(index);
+    }
 
     emitCleanupCode(n, wrapper, params);
 
@@ -1741,15 +2172,28 @@ int JSEmitter::emitFunction(Node *n, bool is_member, bool is_static) {
     ParmList *params = Getattr(n, "parms");
     emit_parameter_variables(params, wrapper);
     emit_attach_parmmaps(params, wrapper);
+    if (is_overloaded) {
+        Swig_typemap_attach_parms("typecheck", params, 0);
+        Setattr(n, "wrap:parms", params);
+    }
 
     // HACK: in test-case `ignore_parameter` emit_attach_parmmaps generates an extra line of applied typemap.
     // Deleting wrapper->code here fixes the problem, and seems to have no side effect elsewhere
     Delete(wrapper->code);
     wrapper->code = NewString("");
 
+    if (!is_overloaded && !Getattr(n, "feature:release_returned_cpp_object_in_gc") && useFastCall(n, params, is_member && !is_static, true)) {
+        t_function = getTemplate("js_fastcall_function");
+    } else if (!is_overloaded && pooledResultClass(n)) {
+        // takes an optional object to write the result into, see js_pool_to_se()
+        t_function = getTemplate("js_pool_function");
+        SetFlag(n, "js:pool:target");
+    }
+
     marshalInputArgs(n, params, wrapper, Function, is_member, is_static);
     String *action = emit_action(n);
     marshalOutput(n, params, wrapper, action);
+    Delattr(n, "js:pool:target");
 
     emitCleanupCode(n, wrapper, params);
     Replaceall(wrapper->code, "$symname", iname);
@@ -1776,6 +2220,10 @@ int JSEmitter::emitFunction(Node *n, bool is_member, bool is_static) {
 
     DelWrapper(wrapper);
 
+    if (GetFlag(n, "feature:js:batch")) {
+        emitBatchFunction(n, wrap_name, is_member, is_static);
+    }
+
     Delete(func_begin);
     Delete(func_end);
 
@@ -1785,29 +2233,326 @@ int JSEmitter::emitFunction(Node *n, bool is_member, bool is_static) {
     return SWIG_OK;
 }
 
-int JSEmitter::emitFunctionDispatcher(Node *n, bool /*is_member */) {
+/* ---------------------------------------------------------------------
+ * emitBatchFunction()
+ *
+ * Generates <wrapper>Batch for a method with %feature("js:batch"), which
+ * takes an array of receivers, unless the method is static, followed by
+ * one array per argument and calls the method for each element.  The
+ * arguments and result are converted with the same typemaps as the plain
+ * wrapper, from a se::Value per element instead of a se::State per call.
+ * Non-void results are returned in an array.
+ * --------------------------------------------------------------------- */
+
+int JSEmitter::emitBatchFunction(Node *n, String *wrap_name, bool is_member, bool is_static) {
     auto& state = currentState();
+    ParmList *params = Getattr(n, "parms");
+    bool has_this = is_member && !is_static;
+
+    if (GetFlag(n, "sym:overloaded")) {
+        if (!Getattr(n, "sym:nextSibling"))
+            Swig_warning(WARN_LANG_OVERLOAD_IGNORED, input_file, line_number, "No batch wrapper is generated for overloaded method %s.\n", Getattr(n, "name"));
+        return SWIG_OK;
+    }
+    if (!is_member || emit_isvarargs(params) || emit_num_arguments(params) == 0) {
+        return SWIG_OK;
+    }
+
+    String *fragment = NewString("js_batch");
+    Swig_fragment_emit(fragment);
+    Delete(fragment);
+
     Wrapper *wrapper = NewWrapper();
+    Template t_function(getTemplate("js_batch_function"));
+    String *batch_name = NewStringf("%sBatch", wrap_name);
+
+    // the typemaps of the plain wrapper have been expanded, attach them again
+    emit_parameter_variables(params, wrapper);
+    emit_attach_parmmaps(params, wrapper);
+    Delete(wrapper->code);
+    wrapper->code = NewString("");
+    if (has_this) {
+        Swig_typemap_attach_parms("in_batch", params, 0);
+        String *tm = Getattr(params, "tmap:in_batch");
+        if (!tm) {
+            Swig_warning(WARN_TYPEMAP_IN_UNDEF, input_file, line_number, "No in_batch typemap for the receiver of %s, no batch wrapper is generated.\n", Getattr(n, "name"));
+            DelWrapper(wrapper);
+            Delete(batch_name);
+            return SWIG_OK;
+        }
+        Setattr(params, "tmap:in", tm);
+    }
+    Delattr(n, "js:fastcall");
+    if (!Getattr(n, "feature:release_returned_cpp_object_in_gc")) {
+        useFastCall(n, params, has_this, true);
+    }
+
+    marshalInputArgs(n, params, wrapper, Batch, is_member, is_static);
+    String *action = emit_action(n);
+    marshalOutput(n, params, wrapper, action);
+    emitCleanupCode(n, wrapper, params);
+    Replaceall(wrapper->code, "$symname", Getattr(n, "sym:name"));
+    if (Getattr(n, "feature:release_returned_cpp_object_in_gc")) {
+        Printv(wrapper->code, "s.rval().toObject()->getPrivateObject()->tryAllowDestroyInGC();\n", NIL);
+    }
+    if (has_this) {
+        // the receiver stands in for the script object of the call
+        Replaceall(wrapper->code, "s.thisObject()", "batchValues[0].toObject()");
+    }
 
-    // Generate call list, go to first node
-    Node *sibl = n;
+    String *results = NewStringEmpty();
+    String *store = NewStringEmpty();
+    String *ret = NewStringEmpty();
+    if (SwigType_type(Getattr(n, "type")) != T_VOID) {
+        Printv(results, "se::HandleObject batchResults(se::Object::createArrayObject(batchCount));", NIL);
+        Printv(store, "batchResults->setArrayElement(batchIndex, s.rval());", NIL);
+        Printv(ret, "s.rval().setObject(batchResults);", NIL);
+    }
 
-    while (Getattr(sibl, "sym:previousSibling"))
-        sibl = Getattr(sibl, "sym:previousSibling"); // go all the way up
+    String *func_begin = NewStringEmpty();
+    String *func_end = NewStringEmpty();
+    String *moduleMacro = Getattr(n, "feature:module_macro");
+    if (moduleMacro) {
+        Printv(func_begin, "#if ", moduleMacro, "\n", NIL);
+        Printv(func_end, "#endif // ", moduleMacro, "\n", NIL);
+    }
 
-    do {
-        String *siblname = Getattr(sibl, "wrap:name");
+    t_function.replace("$jswrapper", batch_name)
+        .replace("$js_func_begin", func_begin)
+        .replace("$js_func_end", func_end)
+        .replace("$jslocals", wrapper->locals)
+        .replace("$jscode", wrapper->code)
+        .replace("$jsargcount", Getattr(n, ARGCOUNT))
+        .replace("$jsbatchresults", results)
+        .replace("$jsbatchstore", store)
+        .replace("$jsbatchreturn", ret)
+        .pretty_print(s_wrappers);
 
-        if (siblname) {
-            // handle function overloading
-            Template t_dispatch_case = getTemplate("js_function_dispatch_case");
-            t_dispatch_case.replace("$jswrapper", siblname)
-                .replace("$jsargcount", Getattr(sibl, ARGCOUNT));
+    state.function(BATCH_WRAPPER_NAME, batch_name);
 
-            Append(wrapper->code, t_dispatch_case.str());
+    DelWrapper(wrapper);
+    Delete(results);
+    Delete(store);
+    Delete(ret);
+    Delete(func_begin);
+    Delete(func_end);
+    Delete(batch_name);
+
+    return SWIG_OK;
+}
+
+/* ---------------------------------------------------------------------
+ * emitDispatchCases()
+ *
+ * Appends the dispatch cases for the overloads of n to out, ranked with
+ * Swig_overload_rank().  Overloads sharing their argument count with
+ * another one first get a case checking the arguments with the typecheck
+ * typemaps, so that the matching wrapper is called in a single pass
+ * instead of trying the conversions of each candidate.  Their loose
+ * checks follow, so that arguments only the conversions accept, such as
+ * 1.5 for an int, still reach an overload.  Only the overloads without
+ * any typecheck typemap get a plain case trying their conversions, in
+ * declaration order.
+ * --------------------------------------------------------------------- */
+
+void JSEmitter::emitDispatchCases(Node *n, const char *dispatch_case, const char *typecheck_case, String *out) {
+    // all the overloads are wrapped, so the shadowing reported by the ranking does not apply
+    static const char *rank_warnings = "467,509,512,516";
+    Swig_warnfilter(rank_warnings, 1);
+    List *ranked = Swig_overload_rank(n, true);
+    Swig_warnfilter(rank_warnings, 0);
+
+    // the ranking leaves out erroneous overloads and repeats implicitconv ones
+    List *candidates = NewList();
+    Hash *seen = NewHash();
+    for (Iterator it = First(ranked); it.item; it = Next(it)) {
+        String *wrapname = Getattr(it.item, "wrap:name");
+        if (wrapname && !Getattr(seen, wrapname)) {
+            Append(candidates, it.item);
+            SetFlag(seen, wrapname);
+        }
+    }
+    Node *sibl = Getattr(n, "sym:overloaded");
+    for (; sibl; sibl = Getattr(sibl, "sym:nextSibling")) {
+        String *wrapname = Getattr(sibl, "wrap:name");
+        if (wrapname && !Getattr(seen, wrapname)) {
+            Append(candidates, sibl);
+            SetFlag(seen, wrapname);
+        }
+    }
+
+    // group the candidates by argument count, keeping the ranked order
+    List *argcounts = NewList();
+    Hash *groups = NewHash();
+    for (Iterator it = First(candidates); it.item; it = Next(it)) {
+        String *argcount = Getattr(it.item, ARGCOUNT);
+        List *group = Getattr(groups, argcount);
+        if (!group) {
+            group = NewList();
+            Setattr(groups, argcount, group);
+            Delete(group);
+            Append(argcounts, argcount);
         }
+        Append(group, it.item);
+    }
 
-    } while ((sibl = Getattr(sibl, "sym:nextSibling")));
+    Hash *checked = NewHash();
+    for (Iterator it = First(argcounts); it.item; it = Next(it)) {
+        List *group = Getattr(groups, it.item);
+        if (Len(group) > 1) {
+            // the strict checks rank the overloads, the loose ones accept what the conversions accept
+            for (int loose = 0; loose < 2; loose++) {
+                for (Iterator c = First(group); c.item; c = Next(c)) {
+                    String *typecheck = emitTypecheck(c.item, loose != 0);
+                    if (Len(typecheck) > 0) {
+                        Template t_case = getTemplate(typecheck_case);
+                        t_case.replace("$jswrapper", Getattr(c.item, "wrap:name"))
+                            .replace("$jsargcount", it.item)
+                            .replace("$jstypecheck", typecheck);
+                        Append(out, t_case.str());
+                        SetFlag(checked, Getattr(c.item, "wrap:name"));
+                    }
+                    Delete(typecheck);
+                }
+            }
+        }
+        // the fallback tries the candidates without a check in declaration order, as before the ranking
+        for (Node *c = Getattr(n, "sym:overloaded"); c; c = Getattr(c, "sym:nextSibling")) {
+            String *wrapname = Getattr(c, "wrap:name");
+            if (wrapname && !Getattr(checked, wrapname) && Equal(Getattr(c, ARGCOUNT), it.item)) {
+                Template t_case = getTemplate(dispatch_case);
+                t_case.replace("$jswrapper", wrapname)
+                    .replace("$jsargcount", it.item);
+                Append(out, t_case.str());
+            }
+        }
+    }
+
+    Delete(checked);
+    Delete(groups);
+    Delete(argcounts);
+    Delete(seen);
+    Delete(candidates);
+    Delete(ranked);
+}
+
+/* ---------------------------------------------------------------------
+ * emitTypecheck()
+ *
+ * Returns the typecheck typemaps of the script arguments of an overload,
+ * each one setting _v and run only while the previous ones passed.  With
+ * loose, the 'loose' attribute of a typecheck typemap replaces its code,
+ * and an empty string is returned when no argument has one.
+ * --------------------------------------------------------------------- */
+
+String *JSEmitter::emitTypecheck(Node *n, bool loose) {
+    ParmList *parms = Getattr(n, "wrap:parms");
+    String *code = NewStringEmpty();
+    bool relaxed = false;
+
+    // the arguments are read the way marshalInputArgs() does, skipping 'this'
+    int startIdx = emit_num_arguments(parms) - atoi(Char(Getattr(n, ARGCOUNT)));
+    int i = 0;
+    for (Parm *p = parms; p; i++) {
+        if (SwigType_isvarargs(Getattr(p, "type")))
+            break;
+        String *tm = Getattr(p, "tmap:typecheck");
+        if (tm && i >= startIdx && !checkAttribute(p, "tmap:in:numinputs", "0")) {
+            String *tm_loose = loose ? Getattr(p, "tmap:typecheck:loose") : 0;
+            if (tm_loose) {
+                tm = tm_loose;
+                relaxed = true;
+            }
+            tm = Copy(tm);
+            String *arg = NewStringf("args[%d]", i - startIdx);
+            Replaceid(tm, Getattr(p, "lname"), "_v");
+            Replaceall(tm, "$input", arg);
+            Printv(code, Len(code) > 0 ? "if (_v) { " : "{ ", tm, " }\n", NIL);
+            Delete(arg);
+            Delete(tm);
+        }
+        p = Getattr(p, "tmap:in") ? Getattr(p, "tmap:in:next") : nextSibling(p);
+    }
+    if (loose && !relaxed)
+        Clear(code);
+    return code;
+}
+
+/* ---------------------------------------------------------------------
+ * cacheSlot()
+ *
+ * Cached members are numbered in the order their getter or setter is
+ * emitted, so that both find the value at the same index. The numbers of
+ * a class follow those of its base classes, whose members share the
+ * slots of the same script object.
+ * --------------------------------------------------------------------- */
+
+String *JSEmitter::cacheSlot(Node *n, String *name) {
+    auto& state = currentState();
+    Hash *slots = state.clazz("js:cache");
+    if (!slots) {
+        slots = NewHash();
+        int offset = 0;
+        for (Node *base = getBaseClass(getClassNode(n)); base; base = getBaseClass(base)) {
+            offset += cachedMemberCount(base);
+        }
+        SetInt(slots, "$offset", offset);
+        state.clazz("js:cache", slots);
+        Delete(slots);
+    }
+    String *index = Getattr(slots, name);
+    if (!index) {
+        index = NewStringf("%d", GetInt(slots, "$offset") + Len(slots) - 1);
+        Setattr(slots, name, index);
+        Delete(index);
+    }
+    return Copy(index);
+}
+
+/* ---------------------------------------------------------------------
+ * useFastCall()
+ *
+ * With -fastcall, marks n to convert its script arguments with in_fast
+ * and its result with out_fast typemaps, if there are at most
+ * FASTCALL_MAX_ARGS arguments and all of them have one. The fast
+ * typemaps only stand in for library in and out typemaps marked fast=1.
+ * --------------------------------------------------------------------- */
+
+bool JSEmitter::useFastCall(Node *n, ParmList *parms, bool has_this, bool has_result) {
+    if (!js_fastcall)
+        return false;
+
+    Swig_typemap_attach_parms("in_fast", parms, 0);
+    int count = 0;
+    int i = 0;
+    for (Parm *p = parms; p; i++) {
+        if (SwigType_isvarargs(Getattr(p, "type")) || !Getattr(p, "tmap:in"))
+            return false;
+        if (!(has_this && i == 0)) {
+            if (!Getattr(p, "tmap:in_fast") || !GetFlag(p, "tmap:in:fast") || Getattr(p, "tmap:in:next") != nextSibling(p))
+                return false;
+            if (++count > FASTCALL_MAX_ARGS)
+                return false;
+        }
+        p = Getattr(p, "tmap:in:next");
+    }
+    if (has_result) {
+        if (Getattr(n, "feature:js:typedarray"))
+            return false;
+        Swig_typemap_lookup("out", n, "", 0);
+        if (!GetFlag(n, "tmap:out:fast") || !Swig_typemap_lookup("out_fast", n, "", 0))
+            return false;
+    }
+
+    SetFlag(n, "js:fastcall");
+    return true;
+}
+
+int JSEmitter::emitFunctionDispatcher(Node *n, bool /*is_member */) {
+    auto& state = currentState();
+    Wrapper *wrapper = NewWrapper();
+
+    emitDispatchCases(n, "js_function_dispatch_case", "js_function_dispatch_typecheck_case", wrapper->code);
 
     Template t_function(getTemplate("js_function_dispatcher"));
 
@@ -1844,12 +2589,17 @@ int JSEmitter::emitFunctionDispatcher(Node *n, bool /*is_member */) {
 }
 
 String *JSEmitter::emitInputTypemap(Node *n, Parm *p, Wrapper *wrapper, String *arg) {
-    // Get input typemap for current param
-    String *tm = Getattr(p, "tmap:in");
+    // Get input typemap for current param, see useFastCall()
+    String *tm = GetFlag(n, "js:fastcall") ? Getattr(p, "tmap:in_fast") : NULL;
+    if (!tm)
+        tm = Getattr(p, "tmap:in");
     SwigType *type = Getattr(p, "type");
 
     if (tm != NULL) {
         Replaceall(tm, "$input", arg);
+        // index of the script argument for SWIG_JS_CHECK_ARG, see marshalInputArgs()
+        String *index = Getattr(p, "emit:jsargindex");
+        Replaceall(tm, "$jsargindex", index ? index : "0");
         Setattr(p, "emit:input", arg);
         // do replacements for built-in variables
         if (Getattr(p, "wrap:disown") || (Getattr(p, "tmap:in:disown"))) {
@@ -1878,12 +2628,42 @@ void JSEmitter::marshalOutput(Node *n, ParmList *params, Wrapper *wrapper, Strin
     if (cresult == 0)
         cresult = defaultResultName;
 
-    tm = Swig_typemap_lookup_out("out", n, cresult, wrapper, actioncode);
+    // %feature("js:typedarray", "adopt"|"wrap") selects an out_adopt or out_wrap typemap when there is one
+    tm = 0;
+    String *typedarray = Getattr(n, "feature:js:typedarray");
+    if (GetFlag(n, "js:fastcall")) {
+        tm = Swig_typemap_lookup_out("out_fast", n, cresult, wrapper, actioncode);
+    } else if (pooledResultClass(n)) {
+        // %feature("js:pool") on the class of the result draws the script object from its free list
+        tm = Swig_typemap_lookup_out("out_pool", n, cresult, wrapper, actioncode);
+        if (tm) {
+            String *target = GetFlag(n, "js:pool:target") ? NewStringf("js_pool_target(args, %s)", Getattr(n, ARGCOUNT)) : NewString("nullptr");
+            Replaceall(tm, "$jspooltarget", target);
+            Delete(target);
+        }
+    } else if (typedarray) {
+        String *method = NewStringf("out_%s", typedarray);
+        tm = Swig_typemap_lookup_out(method, n, cresult, wrapper, actioncode);
+        Delete(method);
+    }
+    if (!tm)
+        tm = Swig_typemap_lookup_out("out", n, cresult, wrapper, actioncode);
     bool should_own = GetFlag(n, "feature:new") != 0;
 
     if (tm) {
         Replaceall(tm, "$objecttype", Swig_scopename_last(SwigType_str(SwigType_strip_qualifiers(type), 0)));
 
+        // with -defer-classes the class of a returned object may not be registered yet
+        Node *classNode = js_lazy_classes ? Language::classLookup(type) : NULL;
+        if (classNode && isWrappedClass(classNode)) {
+            String *mangled = SwigType_namestr(Getattr(classNode, "name"));
+            convertToMangledName(mangled);
+            Template t_require(getTemplate("jsc_class_lazy_require_extern"));
+            t_require.replace("$jsmangledname", mangled)
+                .print(wrapper->code);
+            Delete(mangled);
+        }
+
         if (should_own) {
             Replaceall(tm, "$owner", "SWIG_POINTER_OWN");
         } else {
@@ -2038,6 +2818,7 @@ public:
     virtual int initialize(Node *n);
     virtual int dump(Node *n);
     virtual int close();
+    virtual void trackParallelStreams(ParallelEmitter &parallel);
 
 protected:
     virtual int enterVariable(Node *n);
@@ -2086,9 +2867,9 @@ void CocosEmitter::marshalInputArgs(Node *n, ParmList *parms, Wrapper *wrapper,
     String *tm;
 
     // determine an offset index, as members have an extra 'this' argument
-    // except: static members and ctors.
+    // except: static members, ctors and batch calls, which take the receivers.
     int startIdx = 0;
-    if (is_member && !is_static && mode != Ctor) {
+    if (is_member && !is_static && mode != Ctor && mode != Batch) {
         startIdx = 1;
     }
     // store number of arguments for argument checks
@@ -2107,6 +2888,7 @@ void CocosEmitter::marshalInputArgs(Node *n, ParmList *parms, Wrapper *wrapper,
         if (SwigType_isvarargs(type))
             break;
 
+        int index = i - startIdx;
         switch (mode) {
             case Getter:
             case Function:
@@ -2122,14 +2904,21 @@ void CocosEmitter::marshalInputArgs(Node *n, ParmList *parms, Wrapper *wrapper,
                 } else {
                     Printv(arg, "args[0]", 0);
                 }
+                index = 0;
                 break;
             case Ctor:
                 Printf(arg, "args[%d]", i);
                 break;
+            case Batch:
+                Printf(arg, "batchValues[%d]", i);
+                break;
             default:
                 Printf(stderr, "Illegal MarshallingMode.");
                 Exit(EXIT_FAILURE);
         }
+        String *argindex = NewStringf("%d", index);
+        Setattr(p, "emit:jsargindex", argindex);
+        Delete(argindex);
         tm = emitInputTypemap(n, p, wrapper, arg);
         Delete(arg);
         if (tm) {
@@ -2189,10 +2978,10 @@ int CocosEmitter::initialize(Node *n) {
     Printv(f_wrap_h, "// clang-format off\n\n", 0);
 
     /* Initialization of members */
-    s_runtime = NewString("");
-    s_init = NewString("");
-    s_header = NewString("");
-    s_header_file = NewString("");
+    s_runtime = newSection();
+    s_init = newSection();
+    s_header = newSection();
+    s_header_file = newSection();
 
     /* Register file targets with the SWIG file handler */
     Swig_register_filebyname("begin", f_wrap_cpp);
@@ -2210,6 +2999,10 @@ int CocosEmitter::initialize(Node *n) {
 
     disableWarningsBegin(f_wrap_cpp);
 
+    // nothing else is written to the header file before the header_file section
+    if (!DohIsString(s_header_file))
+        RopeStream(s_header_file, f_wrap_h);
+
     return SWIG_OK;
 }
 
@@ -2255,6 +3048,16 @@ int CocosEmitter::dump(Node *n) {
     return SWIG_OK;
 }
 
+void CocosEmitter::trackParallelStreams(ParallelEmitter &parallel) {
+    JSEmitter::trackParallelStreams(parallel);
+    parallel.trackSection("begin");
+    parallel.trackSection("runtime");
+    parallel.trackSection("header");
+    parallel.trackSection("wrapper");
+    parallel.trackSection("init");
+    parallel.trackSection("header_file");
+}
+
 int CocosEmitter::close() {
     Delete(s_runtime);
     Delete(s_header);
@@ -2306,6 +3109,16 @@ int CocosEmitter::exitFunction(Node *n) {
                 .replace("$jswrapper", state.function(WRAPPER_NAME));
             t_function.pretty_print(state.clazz(MEMBER_FUNCTIONS));
         }
+
+        // the batch wrapper of a method is a static function of its class
+        String *batch_wrapper = state.function(BATCH_WRAPPER_NAME);
+        if (batch_wrapper) {
+            std::string batchname = jsname + "Batch";
+            Template t_batch_function = getTemplate("jsc_static_function_declaration");
+            t_batch_function.replace("$jsname", batchname.c_str())
+                .replace("$jswrapper", batch_wrapper);
+            t_batch_function.pretty_print(state.clazz(STATIC_FUNCTIONS));
+        }
     } else {
         //TODO(cjh): Add feature to control this, disabled by default
 //        Template t_function = getTemplate("jsc_global_function_declaration");
@@ -2433,6 +3246,7 @@ int CocosEmitter::exitClass(Node *n) {
     
     String* jsname = NewStringEmpty();
     auto* nestClassNameList = createNestClassSymNameList(n);
+    bool isNested = nestClassNameList && Len(nestClassNameList) > 1;
     if (nestClassNameList) {
         Append(jsname, "###cc");
         int sz = Len(nestClassNameList);
@@ -2455,6 +3269,13 @@ int CocosEmitter::exitClass(Node *n) {
         Printf(baseClassNameMangled, "%s", Getattr(base_class, "classtype"));
         convertToMangledName(baseClassNameMangled);
 
+        // with -defer-classes the base class may not be registered yet
+        if (js_lazy_classes) {
+            Template t_require(getTemplate("jsc_class_lazy_require"));
+            t_require.replace("$jsmangledname", baseClassNameMangled)
+                .pretty_print(jsclass_inheritance);
+        }
+
         Template t_inherit(getTemplate("jsc_class_inherit"));
         t_inherit.replace("$jsmangledname", state.clazz(NAME_MANGLED))
             .replace("$jsname", jsname)
@@ -2486,6 +3307,27 @@ int CocosEmitter::exitClass(Node *n) {
             .pretty_print(s_jsc_finalize_function);
     }
 
+    // %feature("js:pool") adds Class.recycle(obj, ...)
+    String *poolsize = Getattr(n, "feature:js:pool");
+    if (poolsize) {
+        String *fragment = NewString("js_pool");
+        Swig_fragment_emit(fragment);
+        Delete(fragment);
+
+        Template t_recycle(getTemplate("js_pool_recycle"));
+        t_recycle.replace("$jsmangledname", state.clazz(NAME_MANGLED))
+            .replace("$jsclassname", jsclassname)
+            .replace("$jspoolsize", poolsize)
+            .pretty_print(s_wrappers);
+
+        String *recycle = NewStringf("js_%s_recycle", state.clazz(NAME_MANGLED));
+        Template t_static_function = getTemplate("jsc_static_function_declaration");
+        t_static_function.replace("$jsname", "recycle")
+            .replace("$jswrapper", recycle);
+        t_static_function.pretty_print(state.clazz(STATIC_FUNCTIONS));
+        Delete(recycle);
+    }
+
     std::string static_variables = Char(state.clazz(MEMBER_VARIABLES));
 //    printf("cjh static_variables: %s\n", static_variables.c_str());
 
@@ -2539,6 +3381,13 @@ int CocosEmitter::exitClass(Node *n) {
 
     Printv(s_wrappers, state.globals(INITIALIZER), 0); //cjh added
 
+    // nested classes have no accessor, they are registered with their enclosing class
+    if (js_lazy_classes && !isNested) {
+        Template t_lazy_getter(getTemplate("jsc_class_lazy_getter"));
+        t_lazy_getter.replace("$jsmangledname", state.clazz(NAME_MANGLED))
+            .pretty_print(s_wrappers);
+    }
+
     String *moduleMacro = Getattr(n, "feature:module_macro");
     if (moduleMacro) {
         Printv(s_wrappers, "#endif // ", moduleMacro, "\n", NIL);
@@ -2813,4 +3662,523 @@ void Template::operator=(const Template &t) {
     templateName = NewString(t.templateName);
 }
 
+/* -----------------------------------------------------------------------------
+ * ParallelEmitter
+ * ----------------------------------------------------------------------------- */
+
+ParallelEmitter *ParallelEmitter::instance = NULL;
+
+ParallelEmitter::ParallelEmitter(int jobs)
+: jobs(jobs), worker(0), active(false), reporting(false), errors(0), saved_out(-1), saved_err(-1), out(NULL), err(NULL) {
+}
+
+ParallelEmitter::~ParallelEmitter() {
+    for (size_t i = 0; i < workers.size(); i++) {
+        fclose(workers[i].result);
+        fclose(workers[i].out);
+        fclose(workers[i].err);
+    }
+    if (out)
+        fclose(out);
+    if (err)
+        fclose(err);
+    if (instance == this)
+        instance = NULL;
+}
+
+void ParallelEmitter::trackSection(const char *section) {
+    sections.push_back(section);
+}
+
+void ParallelEmitter::track(String *stream) {
+    streams.push_back(stream);
+    stream_sections.push_back(NULL);
+    files.push_back(NULL);
+}
+
+void ParallelEmitter::partition(Node *top) {
+    classes.push_back(NULL);
+    groups.push_back(0);
+    shared.push_back(false);
+    collectClasses(top, 0);
+
+    for (size_t i = 1; i < classes.size(); i++) {
+        Node *n = classes[i];
+        const char *baselists[] = { "bases", "protectedbases", "privatebases" };
+        for (size_t b = 0; b < sizeof(baselists) / sizeof(baselists[0]); b++) {
+            List *bases = Getattr(n, baselists[b]);
+            for (Iterator it = First(bases); it.item; it = Next(it)) {
+                int j = classOf(it.item);
+                if (j > 0)
+                    joinGroups((int)i, j);
+            }
+        }
+        List *smartpointer = Getattr(n, "allocate:smartpointer");
+        for (Iterator it = First(smartpointer); it.item; it = Next(it)) {
+            joinGroups((int)i, classOf(it.item));
+        }
+    }
+
+    // overloaded methods and friends are dispatched together
+    for (size_t i = 0; i < overloaded.size(); i++) {
+        for (Node *o = Getattr(overloaded[i].second, "sym:overloaded"); o; o = Getattr(o, "sym:nextSibling")) {
+            joinGroups(overloaded[i].first, classOf(o));
+        }
+    }
+
+    // round robin over the groups, the parent owns everything outside of classes
+    std::map<int, int> groupOwner;
+    groupOwner[findGroup(0)] = 0;
+    for (size_t i = 1; i < classes.size(); i++) {
+        int g = findGroup((int)i);
+        if (groupOwner.find(g) == groupOwner.end()) {
+            int owner = (int)groupOwner.size() % jobs;
+            groupOwner[g] = owner;
+        }
+        owners[classes[i]] = shared[i] ? -1 : groupOwner[g];
+    }
+}
+
+void ParallelEmitter::collectClasses(Node *n, int outer) {
+    for (Node *c = firstChild(n); c; c = nextSibling(c)) {
+        if (Equal(nodeType(c), "class")) {
+            int i = outer;
+            if (i == 0) {
+                i = (int)classes.size();
+                classes.push_back(c);
+                groups.push_back(i);
+                shared.push_back(false);
+            }
+            classIndex[c] = i;
+            collectClasses(c, i);
+        } else {
+            if (outer != 0) {
+                String *type = nodeType(c);
+                if (Equal(type, "typemap") || Equal(type, "typemapcopy") || Equal(type, "apply") || Equal(type, "clear") || Equal(type, "fragment")) {
+                    shared[outer] = true;
+                }
+                if (Getattr(c, "sym:overloaded"))
+                    overloaded.push_back(std::make_pair(outer, c));
+            }
+            collectClasses(c, outer);
+        }
+    }
+}
+
+int ParallelEmitter::classOf(Node *n) const {
+    for (; n; n = parentNode(n)) {
+        std::map<Node *, int>::const_iterator it = classIndex.find(n);
+        if (it != classIndex.end())
+            return it->second;
+    }
+    return 0;
+}
+
+int ParallelEmitter::findGroup(int i) {
+    while (groups[i] != i) {
+        groups[i] = groups[groups[i]];
+        i = groups[i];
+    }
+    return i;
+}
+
+void ParallelEmitter::joinGroups(int i, int j) {
+    i = findGroup(i);
+    j = findGroup(j);
+    if (i < j)
+        groups[j] = i;
+    else if (j < i)
+        groups[i] = j;
+}
+
+#ifdef _WIN32
+
+// no fork(), classes are emitted serially
+bool ParallelEmitter::start() {
+    return false;
+}
+
+bool ParallelEmitter::enterUnit(Node *) {
+    return true;
+}
+
+void ParallelEmitter::exitUnit() {
+}
+
+void ParallelEmitter::finish() {
+}
+
+#else
+
+bool ParallelEmitter::start() {
+    for (int w = 1; w < jobs; w++) {
+        Worker wk = Worker();
+        wk.result = tmpfile();
+        wk.out = tmpfile();
+        wk.err = tmpfile();
+        wk.pending = -1;
+        workers.push_back(wk);
+        if (!wk.result || !wk.out || !wk.err)
+            return false;
+    }
+    out = tmpfile();
+    err = tmpfile();
+    if (!out || !err)
+        return false;
+
+    // classes write to strings only, files are written once merged
+    for (size_t i = 0; i < sections.size(); i++) {
+        File *f = Swig_filebyname(sections[i]);
+        if (!f)
+            continue;
+        if (DohIsString(f)) {
+            streams.push_back(f);
+            files.push_back(NULL);
+        } else {
+            String *s = NewStringEmpty();
+            Swig_register_filebyname(sections[i], s);
+            streams.push_back(s);
+            files.push_back(f);
+        }
+        stream_sections.push_back(sections[i]);
+    }
+
+    // only stdout and stderr, the workers never flush the buffers of other files
+    fflush(stdout);
+    fflush(stderr);
+    saved_out = dup(STDOUT_FILENO);
+    saved_err = dup(STDERR_FILENO);
+    errors = Swig_error_count();
+    Swig_fragment_mark(1);
+
+    for (size_t w = 0; w < workers.size(); w++) {
+        int pid = fork();
+        if (pid == 0) {
+            worker = (int)w + 1;
+            dup2(fileno(workers[w].out), STDOUT_FILENO);
+            dup2(fileno(workers[w].err), STDERR_FILENO);
+            instance = this;
+            SetExitHandler(workerExit);
+            active = true;
+            return true;
+        }
+        workers[w].pid = pid;
+        if (pid < 0) {
+            Printf(stderr, "Unable to fork worker process for -j%d.\n", jobs);
+            instance = this;
+            active = true;
+            parentExit();
+            Exit(EXIT_FAILURE);
+        }
+    }
+
+    dup2(fileno(out), STDOUT_FILENO);
+    dup2(fileno(err), STDERR_FILENO);
+    if (!instance)
+        atexit(parentExit);
+    signal(SIGABRT, parentSignal);
+    signal(SIGSEGV, parentSignal);
+    instance = this;
+    active = true;
+    return true;
+}
+
+bool ParallelEmitter::enterUnit(Node *n) {
+    int k = (int)units.size();
+    Unit u = Unit();
+    std::map<Node *, int>::const_iterator it = owners.find(n);
+    u.owner = it != owners.end() ? it->second : 0;
+    reporting = false;
+    if (u.owner < 0) {
+        // emitted by all processes, the output of the parent is used
+        u.owner = 0;
+        units.push_back(u);
+        if (worker != 0)
+            return true;
+    } else {
+        units.push_back(u);
+        if (u.owner != worker && worker != 0)
+            return false;
+        reporting = worker != 0;
+    }
+
+    Unit &unit = units.back();
+    fflush(stdout);
+    fflush(stderr);
+    unit.out_start = unit.out_end = lseek(STDOUT_FILENO, 0, SEEK_CUR);
+    unit.err_start = unit.err_end = lseek(STDERR_FILENO, 0, SEEK_CUR);
+    for (size_t i = 0; i < streams.size(); i++) {
+        unit.start.push_back(Len(streams[i]));
+        unit.end.push_back(Len(streams[i]));
+    }
+    if (reporting) {
+        FILE *f = workers[worker - 1].result;
+        fputc('S', f);
+        fwrite(&k, sizeof(k), 1, f);
+        fwrite(&unit.out_start, sizeof(long), 1, f);
+        fwrite(&unit.err_start, sizeof(long), 1, f);
+        fflush(f);
+    }
+    return u.owner == worker;
+}
+
+void ParallelEmitter::exitUnit() {
+    if (worker != 0 && !reporting)
+        return;
+    int k = (int)units.size() - 1;
+    Unit &unit = units.back();
+    fflush(stdout);
+    fflush(stderr);
+    unit.out_end = lseek(STDOUT_FILENO, 0, SEEK_CUR);
+    unit.err_end = lseek(STDERR_FILENO, 0, SEEK_CUR);
+    for (size_t i = 0; i < streams.size(); i++)
+        unit.end[i] = Len(streams[i]);
+    if (reporting) {
+        FILE *f = workers[worker - 1].result;
+        fputc('U', f);
+        fwrite(&k, sizeof(k), 1, f);
+        for (size_t i = 0; i < streams.size(); i++) {
+            int len = unit.end[i] - unit.start[i];
+            fwrite(&len, sizeof(len), 1, f);
+            fwrite(Char(streams[i]) + unit.start[i], 1, len, f);
+        }
+        fwrite(&unit.out_end, sizeof(long), 1, f);
+        fwrite(&unit.err_end, sizeof(long), 1, f);
+        fflush(f);
+    }
+}
+
+void ParallelEmitter::finish() {
+    if (worker != 0) {
+        FILE *f = workers[worker - 1].result;
+        int n = Swig_error_count() - errors;
+        fputc('E', f);
+        fwrite(&n, sizeof(n), 1, f);
+        fflush(f);
+        fflush(stdout);
+        fflush(stderr);
+        _exit(EXIT_SUCCESS);
+    }
+
+    for (size_t w = 0; w < workers.size(); w++) {
+        int status = 0;
+        while (waitpid(workers[w].pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        readResults(workers[w]);
+        workers[w].status = status;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+            workers[w].ok = false;
+    }
+    active = false;
+    signal(SIGABRT, SIG_DFL);
+    signal(SIGSEGV, SIG_DFL);
+    Swig_fragment_mark(0);
+
+    // the first unit not emitted due to a failed worker
+    int failed = (int)units.size();
+    Worker *failedWorker = NULL;
+    for (size_t w = 0; w < workers.size(); w++) {
+        if (!workers[w].ok) {
+            int k = workers[w].pending >= 0 ? workers[w].pending : (int)units.size();
+            if (!failedWorker || k < failed) {
+                failed = k;
+                failedWorker = &workers[w];
+            }
+        }
+    }
+
+    std::string merged_out = mergeCapture(true, failed);
+    std::string merged_err = mergeCapture(false, failed);
+    restoreOutput();
+    fwrite(merged_out.data(), 1, merged_out.size(), stdout);
+    fwrite(merged_err.data(), 1, merged_err.size(), stderr);
+
+    if (failedWorker) {
+        std::string tail_out = readRange(failedWorker->out, failedWorker->pending_out, -1);
+        std::string tail_err = readRange(failedWorker->err, failedWorker->pending_err, -1);
+        fwrite(tail_out.data(), 1, tail_out.size(), stdout);
+        fwrite(tail_err.data(), 1, tail_err.size(), stderr);
+        fflush(stdout);
+        fflush(stderr);
+        if (WIFSIGNALED(failedWorker->status))
+            raise(WTERMSIG(failedWorker->status));
+        Exit(EXIT_FAILURE);
+    }
+
+    for (size_t w = 0; w < workers.size(); w++)
+        Swig_error_count_add(workers[w].errors);
+
+    Hash *emitted = NewHash();
+    for (size_t i = 0; i < streams.size(); i++) {
+        std::string merged;
+        const char *s = Char(streams[i]);
+        int pos = 0;
+        for (size_t k = 0; k < units.size(); k++) {
+            const Unit &unit = units[k];
+            merged.append(s + pos, unit.start[i] - pos);
+            if (unit.owner == 0)
+                merged.append(s + unit.start[i], unit.end[i] - unit.start[i]);
+            else
+                merged.append(unit.output[i]);
+            pos = unit.end[i];
+        }
+        merged.append(s + pos);
+
+        String *unmarked = Swig_fragment_unmark(merged.c_str(), emitted);
+        Clear(streams[i]);
+        Append(streams[i], unmarked);
+        Delete(unmarked);
+    }
+    Delete(emitted);
+
+    for (size_t i = 0; i < streams.size(); i++) {
+        if (files[i]) {
+            Printv(files[i], streams[i], NIL);
+            Swig_register_filebyname(stream_sections[i], files[i]);
+            Delete(streams[i]);
+        }
+    }
+}
+
+void ParallelEmitter::readResults(Worker &w) {
+    FILE *f = w.result;
+    int c;
+    w.ok = false;
+    w.pending = -1;
+    rewind(f);
+    while ((c = fgetc(f)) != EOF) {
+        int k;
+        if (fread(&k, sizeof(k), 1, f) != 1)
+            break;
+        if (c == 'E') {
+            w.errors = k;
+            w.ok = true;
+            break;
+        }
+        if (k < 0 || k >= (int)units.size())
+            break;
+        Unit &unit = units[k];
+        if (c == 'S') {
+            w.pending = k;
+            if (fread(&w.pending_out, sizeof(long), 1, f) != 1 || fread(&w.pending_err, sizeof(long), 1, f) != 1)
+                break;
+            unit.wout_start = w.pending_out;
+            unit.werr_start = w.pending_err;
+        } else if (c == 'U') {
+            unit.output.resize(streams.size());
+            for (size_t i = 0; i < streams.size(); i++) {
+                int len;
+                if (fread(&len, sizeof(len), 1, f) != 1)
+                    return;
+                unit.output[i].resize(len);
+                if (len && fread(&unit.output[i][0], 1, len, f) != (size_t)len)
+                    return;
+            }
+            if (fread(&unit.wout_end, sizeof(long), 1, f) != 1 || fread(&unit.werr_end, sizeof(long), 1, f) != 1)
+                return;
+            w.pending = -1;
+            w.pending_out = unit.wout_end;
+            w.pending_err = unit.werr_end;
+        } else {
+            break;
+        }
+    }
+}
+
+std::string ParallelEmitter::mergeCapture(bool is_out, int upto) const {
+    std::string merged;
+    FILE *capture = is_out ? out : err;
+    long pos = 0;
+    for (int k = 0; k < upto; k++) {
+        const Unit &unit = units[k];
+        long start = is_out ? unit.out_start : unit.err_start;
+        long end = is_out ? unit.out_end : unit.err_end;
+        merged += readRange(capture, pos, start);
+        if (unit.owner == 0) {
+            merged += readRange(capture, start, end);
+        } else {
+            const Worker &w = workers[unit.owner - 1];
+            if (is_out)
+                merged += readRange(w.out, unit.wout_start, unit.wout_end);
+            else
+                merged += readRange(w.err, unit.werr_start, unit.werr_end);
+        }
+        pos = end;
+    }
+    if (upto < (int)units.size())
+        merged += readRange(capture, pos, is_out ? units[upto].out_start : units[upto].err_start);
+    else
+        merged += readRange(capture, pos, -1);
+    return merged;
+}
+
+void ParallelEmitter::restoreOutput() {
+    fflush(stdout);
+    fflush(stderr);
+    dup2(saved_out, STDOUT_FILENO);
+    dup2(saved_err, STDERR_FILENO);
+    close(saved_out);
+    close(saved_err);
+}
+
+std::string ParallelEmitter::readRange(FILE *f, long from, long to) {
+    std::string s;
+    char buffer[4096];
+    if (to < 0)
+        to = lseek(fileno(f), 0, SEEK_END);
+    while (from < to) {
+        long n = to - from < (long)sizeof(buffer) ? to - from : (long)sizeof(buffer);
+        ssize_t got = pread(fileno(f), buffer, n, from);
+        if (got <= 0)
+            break;
+        s.append(buffer, got);
+        from += got;
+    }
+    return s;
+}
+
+void ParallelEmitter::copyCapture(FILE *f, int fd) {
+    char buffer[4096];
+    ssize_t got;
+    off_t from = 0;
+    while ((got = pread(fileno(f), buffer, sizeof(buffer), from)) > 0) {
+        if (write(fd, buffer, got) != got)
+            break;
+        from += got;
+    }
+}
+
+void ParallelEmitter::workerExit(int status) {
+    fflush(instance->workers[instance->worker - 1].result);
+    fflush(stdout);
+    fflush(stderr);
+    _exit(status == EXIT_SUCCESS ? EXIT_FAILURE : status);
+}
+
+void ParallelEmitter::parentExit() {
+    ParallelEmitter *p = instance;
+    if (!p || !p->active || p->worker != 0)
+        return;
+    p->active = false;
+    for (size_t w = 0; w < p->workers.size(); w++) {
+        if (p->workers[w].pid > 0) {
+            kill(p->workers[w].pid, SIGKILL);
+            waitpid(p->workers[w].pid, NULL, 0);
+        }
+    }
+    p->restoreOutput();
+    copyCapture(p->out, STDOUT_FILENO);
+    copyCapture(p->err, STDERR_FILENO);
+}
+
+void ParallelEmitter::parentSignal(int sig) {
+    fflush(stdout);
+    fflush(stderr);
+    parentExit();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+#endif
+
 } // namespace cc
@@ -59,22 +59,37 @@ extern "C" {
   extern int kwargs_supported;
 }
 
+/* the default of -arena/-noarena follows the DOH_ARENA build option */
+#ifdef DOH_ARENA
+#define ARENA_DEFAULT " (default)"
+#define NOARENA_DEFAULT ""
+#else
+#define ARENA_DEFAULT ""
+#define NOARENA_DEFAULT " (default)"
+#endif
+
 /* usage string split into multiple parts otherwise string is too big for some compilers */
 /* naming conventions for commandline options - no underscores, no capital letters, join words together
  * except when using a common prefix, then use '-' to separate, eg the debug-xxx options */
 static const char *usage1 = (const char *) "\
 \nGeneral Options\n\
      -addextern      - Add extra extern declarations\n\
+     -arena          - Allocate DOH object data from size-classed arena pools and\n\
+                       release it in bulk at exit" ARENA_DEFAULT "\n\
      -c++            - Enable C++ processing\n\
      -co <file>      - Check <file> out of the SWIG library\n\
      -copyctor       - Automatically generate copy constructors wherever possible\n\
+     -cppcache <dir> - Cache the preprocessed SWIG library prelude in directory <dir>\n\
+     -cppmemo        - Reuse the results of repeated identical macro expansions\n\
      -cpperraswarn   - Treat the preprocessor #error statement as #warning (default)\n\
      -cppext <ext>   - Change file extension of generated C++ files to <ext>\n\
                        (default is cxx)\n\
      -copyright      - Display copyright notices\n\
      -debug-classes  - Display information about the classes found in the interface\n\
+     -debug-cpp-stats - Display preprocessor macro expansion and prelude cache statistics\n\
      -debug-module <n>- Display module parse tree at stages 1-4, <n> is a csv list of stages\n\
      -debug-symtabs  - Display symbol tables information\n\
+     -debug-symtabs-stats - Display symbol lookup cache statistics\n\
      -debug-symbols  - Display target language symbols in the symbol tables\n\
      -debug-csymbols - Display C symbols in the symbol tables\n\
      -debug-lsymbols - Display target language layer symbols\n\
@@ -84,6 +99,7 @@ static const char *usage1 = (const char *) "\
      -debug-top <n>  - Display entire parse tree at stages 1-4, <n> is a csv list of stages\n\
      -debug-typedef  - Display information about the types and typedefs in the interface\n\
      -debug-typemap  - Display typemap debugging information\n\
+     -debug-tmcache  - Display typemap search cache statistics\n\
      -debug-tmsearch - Display typemap search debugging information\n\
      -debug-tmused   - Display typemaps used debugging information\n\
      -directors      - Turn on director mode for all the classes, mainly for testing\n\
@@ -123,6 +139,7 @@ static const char *usage3 = (const char *) "\
      -module <name>  - Set module name to <name>\n\
      -MP             - Generate phony targets for all dependencies\n\
      -MT <target>    - Set the target of the rule emitted by dependency generation\n\
+     -noarena        - Allocate DOH object data with malloc/free" NOARENA_DEFAULT "\n\
      -nocontract     - Turn off contract checking\n\
      -nocpperraswarn - Do not treat the preprocessor #error statement as #warning\n\
      -nodefault      - Do not generate default constructors nor default destructors\n\
@@ -190,7 +207,11 @@ static int no_cpp = 0;
 static String *outfile_name = 0;
 static String *outfile_name_h = 0;
 static int tm_debug = 0;
+static int tmcache_debug = 0;
+static String *cpp_cache_dir = 0;
+static int cpp_stats = 0;
 static int dump_symtabs = 0;
+static int symtabs_stats = 0;
 static int dump_symbols = 0;
 static int dump_csymbols = 0;
 static int dump_lang_symbols = 0;
@@ -694,6 +715,18 @@ static void getoptions(int argc, char *argv[]) {
       } else if (strcmp(argv[i], "-nocpperraswarn") == 0) {
 	Preprocessor_error_as_warning(0);
 	Swig_mark_arg(i);
+      } else if (strcmp(argv[i], "-cppcache") == 0) {
+	Swig_mark_arg(i);
+	if (argv[i + 1]) {
+	  cpp_cache_dir = NewString(argv[i + 1]);
+	  Swig_mark_arg(i + 1);
+	  i++;
+	} else {
+	  Swig_arg_error();
+	}
+      } else if (strcmp(argv[i], "-cppmemo") == 0) {
+	Preprocessor_memoize(1);
+	Swig_mark_arg(i);
       } else if (strcmp(argv[i], "-cppext") == 0) {
 	Swig_mark_arg(i);
 	if (argv[i + 1]) {
@@ -706,6 +739,13 @@ static void getoptions(int argc, char *argv[]) {
       } else if ((strcmp(argv[i], "-debug-typemap") == 0) || (strcmp(argv[i], "-debug_typemap") == 0) || (strcmp(argv[i], "-tm_debug") == 0)) {
 	tm_debug = 1;
 	Swig_mark_arg(i);
+      } else if (strcmp(argv[i], "-debug-cpp-stats") == 0) {
+	cpp_stats = 1;
+	Preprocessor_stats(1);
+	Swig_mark_arg(i);
+      } else if (strcmp(argv[i], "-debug-tmcache") == 0) {
+	tmcache_debug = 1;
+	Swig_mark_arg(i);
       } else if (strcmp(argv[i], "-debug-tmsearch") == 0) {
 	Swig_typemap_search_debug_set();
 	Swig_mark_arg(i);
@@ -785,6 +825,9 @@ static void getoptions(int argc, char *argv[]) {
       } else if (strcmp(argv[i], "-debug-quiet") == 0) {
 	Swig_print_quiet(1);
 	Swig_mark_arg(i);
+      } else if (strcmp(argv[i], "-debug-symtabs-stats") == 0) {
+	symtabs_stats = 1;
+	Swig_mark_arg(i);
       } else if (strcmp(argv[i], "-debug-symtabs") == 0) {
 	dump_symtabs = 1;
 	Swig_mark_arg(i);
@@ -862,6 +905,9 @@ static void getoptions(int argc, char *argv[]) {
       } else if ((strcmp(argv[i], "-debug-memory") == 0) || (strcmp(argv[i], "-dump_memory") == 0)) {
 	memory_debug = 1;
 	Swig_mark_arg(i);
+      } else if ((strcmp(argv[i], "-arena") == 0) || (strcmp(argv[i], "-noarena") == 0)) {
+	// Already handled by select_arena()
+	Swig_mark_arg(i);
       } else if (strcmp(argv[i], "-Fstandard") == 0) {
 	Swig_error_msg_format(EMF_STANDARD);
 	Swig_mark_arg(i);
@@ -886,9 +932,32 @@ static void getoptions(int argc, char *argv[]) {
 
 static void SWIG_exit_handler(int status);
 
+/* -----------------------------------------------------------------------------
+ * select_arena()
+ *
+ * Handle -arena/-noarena ahead of the other options as the DOH allocation
+ * scheme has to be chosen before the first DOH object is created.
+ * ----------------------------------------------------------------------------- */
+
+static void select_arena(int argc, char *argv[]) {
+  for (int i = 1; i < argc; i++) {
+    if (argv[i]) {
+      int on = -1;
+      if (strcmp(argv[i], "-arena") == 0)
+	on = 1;
+      else if (strcmp(argv[i], "-noarena") == 0)
+	on = 0;
+      if (on != -1 && !DohArenaEnable(on))
+	fprintf(stderr, "Ignoring %s as DOH objects have already been allocated.\n", argv[i]);
+    }
+  }
+}
+
 int SWIG_main(int argc, char *argv[], const TargetLanguageModule *tlm) {
   char *c;
 
+  select_arena(argc, argv);
+
   /* Set function for Exit() to call. */
   SetExitHandler(SWIG_exit_handler);
 
@@ -1055,6 +1124,7 @@ int SWIG_main(int argc, char *argv[], const TargetLanguageModule *tlm) {
     {
       int i;
       String *fs = NewString("");
+      String *prelude = 0;
       FILE *df = Swig_open(input_file);
       if (!df) {
 	df = Swig_include_open(input_file);
@@ -1087,12 +1157,27 @@ int SWIG_main(int argc, char *argv[], const TargetLanguageModule *tlm) {
 	if (lang_config) {
 	  Printf(fs, "\n%%include <%s>\n", lang_config);
 	}
+	if (cpp_cache_dir) {
+	  // The prelude is the same for every interface file, so preprocess it on its own and reuse earlier results
+	  prelude = fs;
+	  fs = NewString("");
+	}
 	Printf(fs, "%%include(maininput=\"%s\") \"%s\"\n", Swig_filename_escape(input_file), Swig_filename_escape(Swig_last_file()));
 	for (i = 0; i < Len(libfiles); i++) {
 	  Printf(fs, "\n%%include \"%s\"\n", Swig_filename_escape(Getitem(libfiles, i)));
 	}
+	if (prelude) {
+	  String *ps = prelude;
+	  Seek(ps, 0, SEEK_SET);
+	  prelude = Preprocessor_parse_cached(ps, cpp_cache_dir);
+	  Delete(ps);
+	}
 	Seek(fs, 0, SEEK_SET);
 	cpps = Preprocessor_parse(fs);
+	if (prelude) {
+	  Insert(cpps, 0, prelude);
+	  Delete(prelude);
+	}
 	Delete(fs);
       } else {
 	cpps = Swig_read_file(df);
@@ -1103,6 +1188,8 @@ int SWIG_main(int argc, char *argv[], const TargetLanguageModule *tlm) {
       }
       if (cpp_only) {
 	Printf(stdout, "%s", cpps);
+	if (cpp_stats)
+	  Preprocessor_stats_debug();
 	Exit(EXIT_SUCCESS);
       }
       if (depend) {
@@ -1341,10 +1428,18 @@ int SWIG_main(int argc, char *argv[], const TargetLanguageModule *tlm) {
       lang = 0;
       Swig_print_xml(top, xmlout);
     }
-    Delete(top);
+    // With the arena the whole tree is released in one go by DohArenaRelease()
+    if (!DohArenaEnabled())
+      Delete(top);
   }
   if (tm_debug)
     Swig_typemap_debug();
+  if (tmcache_debug)
+    Swig_typemap_search_cache_debug();
+  if (symtabs_stats)
+    Swig_symbol_cache_debug();
+  if (cpp_stats)
+    Preprocessor_stats_debug();
   if (memory_debug)
     DohMemoryDebug();
 
@@ -1378,6 +1473,8 @@ int SWIG_main(int argc, char *argv[], const TargetLanguageModule *tlm) {
   if (error_count != 0)
     Exit(EXIT_FAILURE);
 
+  DohArenaRelease();
+
   return 0;
 }
 
@@ -55,6 +55,7 @@ static Hash *builtin_closures = 0;
 static Hash *class_members = 0;
 static File *f_builtins = 0;
 static String *builtin_tp_init = 0;
+static bool builtin_tp_init_fastcall = false;
 static String *builtin_methods = 0;
 static String *builtin_default_unref = 0;
 static String *builtin_closures_code = 0;
@@ -79,12 +80,15 @@ static String *real_classname;
 /* Thread Support */
 static int threads = 0;
 static int nothreads = 0;
+static int releasegil = 0;
 
 /* Other options */
 static int dirvtable = 0;
 static int doxygen = 0;
 static int fastunpack = 1;
+static int fastcall = 0;
 static int fastproxy = 0;
+static int thisslot = 0;
 static int olddefs = 0;
 static int castmode = 0;
 static int extranative = 0;
@@ -115,6 +119,7 @@ Python Options (available with -python)\n\
      -dirvtable      - Generate a pseudo virtual table for directors for faster dispatch\n\
      -doxygen        - Convert C++ doxygen comments to pydoc comments in proxy classes\n\
      -extranative    - Return extra native wrappers for C++ std containers wherever possible\n\
+     -fastcall       - Pass the arguments to the wrappers as a C array (METH_FASTCALL and vectorcall)\n\
      -fastproxy      - Use fast proxy mechanism for member methods\n\
      -flatstaticmethod         - Generate additional flattened Python methods for C++ static methods\n\
      -globals <name> - Set <name> used to access C global variable (default: 'cvar')\n\
@@ -126,9 +131,11 @@ static const char *usage2 = "\
 static const char *usage3 = "\
      -noproxy        - Don't generate proxy classes\n\
      -nortti         - Disable the use of the native C++ RTTI with directors\n\
+     -nothisslot     - Store 'this' in the instance dictionary of proxy classes (default)\n\
      -nothreads      - Disable thread support for the entire interface\n\
      -olddefs        - Keep the old method definitions when using -fastproxy\n\
      -relativeimport - Use relative Python imports\n\
+     -thisslot       - Store 'this' of proxy classes in a slot of a shared SwigPyProxy base class\n\
      -threads        - Add thread support for all the interface\n\
      -O              - Enable the following optimization options:\n\
                          -fastdispatch -fastproxy -fvirtual\n\
@@ -169,6 +176,7 @@ static String *getClosure(String *functype, String *wrapper, int funpack = 0) {
     "reprfunc", "SWIGPY_REPRFUNC_CLOSURE",
     "hashfunc", "SWIGPY_HASHFUNC_CLOSURE",
     "iternextfunc", "SWIGPY_ITERNEXTFUNC_CLOSURE",
+    "getbufferproc", "SWIGPY_GETBUFFERPROC_CLOSURE",
     NULL
   };
 
@@ -189,6 +197,7 @@ static String *getClosure(String *functype, String *wrapper, int funpack = 0) {
     "reprfunc", "SWIGPY_REPRFUNC_CLOSURE",
     "hashfunc", "SWIGPY_HASHFUNC_CLOSURE",
     "iternextfunc", "SWIGPY_ITERNEXTFUNC_CLOSURE",
+    "getbufferproc", "SWIGPY_FUNPACK_GETBUFFERPROC_CLOSURE",
     NULL
   };
 
@@ -231,11 +240,27 @@ public:
    * Thread Implementation
    * ------------------------------------------------------------ */
   int threads_enable(Node *n) const {
-    return threads && !GetFlagAttr(n, "feature:nothread");
+    return (threads || releasegil) && !GetFlagAttr(n, "feature:nothread");
+  }
+
+  /* With -threads every wrapper releases the GIL, otherwise only those marked by %pythonreleasegil */
+  int releasegil_enable(Node *n) const {
+    return threads_enable(n) && (threads || GetFlag(n, "feature:python:releasegil"));
+  }
+
+  /* Look for a feature set on any declaration outside of %import */
+  static int uses_feature(Node *n, const char *feature) {
+    for (; n; n = nextSibling(n)) {
+      if (GetFlag(n, feature))
+	return 1;
+      if (Cmp(nodeType(n), "import") != 0 && uses_feature(firstChild(n), feature))
+	return 1;
+    }
+    return 0;
   }
 
   int initialize_threads(String *f_init) {
-    if (!threads) {
+    if (!threads && !releasegil) {
       return SWIG_OK;
     }
     Printf(f_init, "\n");
@@ -359,12 +384,21 @@ public:
 	} else if (strcmp(argv[i], "-nofastunpack") == 0) {
 	  fastunpack = 0;
 	  Swig_mark_arg(i);
+	} else if (strcmp(argv[i], "-fastcall") == 0) {
+	  fastcall = 1;
+	  Swig_mark_arg(i);
 	} else if (strcmp(argv[i], "-fastproxy") == 0) {
 	  fastproxy = 1;
 	  Swig_mark_arg(i);
 	} else if (strcmp(argv[i], "-olddefs") == 0) {
 	  olddefs = 1;
 	  Swig_mark_arg(i);
+	} else if (strcmp(argv[i], "-thisslot") == 0) {
+	  thisslot = 1;
+	  Swig_mark_arg(i);
+	} else if (strcmp(argv[i], "-nothisslot") == 0) {
+	  thisslot = 0;
+	  Swig_mark_arg(i);
 	} else if (strcmp(argv[i], "-castmode") == 0) {
 	  castmode = 1;
 	  Swig_mark_arg(i);
@@ -593,9 +627,12 @@ public:
       Printf(f_runtime, "#define SWIG_DIRECTORS\n");
     }
 
+    /* %pythonreleasegil needs the thread support of -threads, director upcalls included */
+    releasegil = !threads && !nothreads && uses_feature(n, "feature:python:releasegil");
+
     if (nothreads) {
       Printf(f_runtime, "#define SWIG_PYTHON_NO_THREADS\n");
-    } else if (threads) {
+    } else if (threads || releasegil) {
       Printf(f_runtime, "#define SWIG_PYTHON_THREADS\n");
     }
 
@@ -622,10 +659,18 @@ public:
       Printf(f_runtime, "#define SWIGPYTHON_BUILTIN\n");
     }
 
+    if (fastcall && fastunpack) {
+      Printf(f_runtime, "#define SWIG_PYTHON_FASTCALL\n");
+    }
+
     if (fastproxy) {
       Printf(f_runtime, "#define SWIGPYTHON_FASTPROXY\n");
     }
 
+    if (!builtin && shadow && thisslot) {
+      Printf(f_runtime, "#define SWIG_PYTHON_THISSLOT\n");
+    }
+
     Printf(f_runtime, "\n");
 
     Printf(f_header, "#ifdef SWIG_TypeQuery\n");
@@ -723,6 +768,11 @@ public:
 	Printf(f_shadow, "_swig_new_static_method = %s.SWIG_PyStaticMethod_New\n", module);
       }
 
+      if (!builtin && thisslot) {
+	Printf(f_shadow, "\n");
+	Printf(f_shadow, "_SwigPyProxy = %s.SWIG_PyProxyBase()\n", module);
+      }
+
       if (!builtin) {
 	Printv(f_shadow, "\n",
 	       "def _swig_repr(self):\n",
@@ -794,6 +844,7 @@ public:
     /* the method exported for replacement of new.instancemethod in Python 3 */
     add_pyinstancemethod_new();
     add_pystaticmethod_new();
+    add_pyproxybase();
 
     if (builtin) {
       SwigType *s = NewString("SwigPyObject");
@@ -953,6 +1004,21 @@ public:
     return 0;
   }
 
+  /* ------------------------------------------------------------
+   * Emit the wrapper returning the SwigPyProxy class to MethodDef
+   * array. The proxy classes without proxy bases derive from it to
+   * store 'this' in a slot.
+   * ------------------------------------------------------------ */
+  int add_pyproxybase() {
+    if (!builtin && shadow && thisslot) {
+      String *line = NewString("\t { \"SWIG_PyProxyBase\", SWIG_PyProxyBase, METH_NOARGS, NULL},\n");
+      Append(methods, line);
+      Append(methods_proxydocs, line);
+      Delete(line);
+    }
+    return 0;
+  }
+
   /* ------------------------------------------------------------
    * subpkg_tail()
    *
@@ -2460,21 +2526,35 @@ public:
 
 
 
+  /* ------------------------------------------------------------
+   * use_fastcall()
+   *
+   * Whether the wrapper of n, or its overload dispatcher, takes its
+   * arguments as a C array with -fastcall. Builtin slots and comparison
+   * operators keep the tuple signature their closures call them with.
+   * ------------------------------------------------------------ */
+
+  bool use_fastcall(Node *n) {
+    if (!fastcall || !fastunpack)
+      return false;
+    if (builtin && (Getattr(n, "feature:python:slot") || Getattr(n, "feature:python:compare")))
+      return false;
+    return !emit_isvarargs_function(n);
+  }
+
   /* ------------------------------------------------------------
    * add_method()
    * ------------------------------------------------------------ */
 
-  void add_method(String *name, String *function, int kw, Node *n = 0, int funpack = 0, int num_required = -1, int num_arguments = -1) {
+  void add_method(String *name, String *function, int kw, Node *n = 0, int funpack = 0, int num_required = -1, int num_arguments = -1, int fastcall_wrapper = 0) {
     String * meth_str = NewString("");
     if (!kw) {
-      if (funpack) {
-	if (num_required == 0 && num_arguments == 0) {
-	  Printf(meth_str, "\t { \"%s\", %s, METH_NOARGS, ", name, function);
-	} else if (num_required == 1 && num_arguments == 1) {
-	  Printf(meth_str, "\t { \"%s\", %s, METH_O, ", name, function);
-	} else {
-	  Printf(meth_str, "\t { \"%s\", %s, METH_VARARGS, ", name, function);
-	}
+      if (funpack && num_required == 0 && num_arguments == 0) {
+	Printf(meth_str, "\t { \"%s\", %s, METH_NOARGS, ", name, function);
+      } else if (funpack && num_required == 1 && num_arguments == 1) {
+	Printf(meth_str, "\t { \"%s\", %s, METH_O, ", name, function);
+      } else if (fastcall_wrapper) {
+	Printf(meth_str, "\t { \"%s\", (PyCFunction)(void(*)(void))%s, METH_FASTCALL, ", name, function);
       } else {
 	Printf(meth_str, "\t { \"%s\", %s, METH_VARARGS, ", name, function);
       }
@@ -2482,7 +2562,7 @@ public:
       // Cast via void(*)(void) to suppress GCC -Wcast-function-type warning.
       // Python should always call the function correctly, but the Python C API
       // requires us to store it in function pointer of a different type.
-      Printf(meth_str, "\t { \"%s\", (PyCFunction)(void(*)(void))%s, METH_VARARGS|METH_KEYWORDS, ", name, function);
+      Printf(meth_str, "\t { \"%s\", (PyCFunction)(void(*)(void))%s, %s, ", name, function, fastcall_wrapper ? "METH_FASTCALL|METH_KEYWORDS" : "METH_VARARGS|METH_KEYWORDS");
     }
     Append(methods, meth_str);
     if (fastproxy) {
@@ -2563,8 +2643,13 @@ public:
     String *symname = Getattr(n, "sym:name");
     String *wname = Swig_name_wrapper(symname);
 
+    /* With -fastcall the dispatcher unpacks the argument array as well */
+    int fastcall_dispatch = funpack && use_fastcall(n);
     const char *builtin_kwargs = builtin_ctor ? ", PyObject *kwargs" : "";
-    Printv(f->def, linkage, builtin_ctor ? "int " : "PyObject *", wname, "(PyObject *self, PyObject *args", builtin_kwargs, ") {", NIL);
+    if (fastcall_dispatch)
+      Printv(f->def, linkage, builtin_ctor ? "int " : "PyObject *", wname, "(PyObject *self, PyObject *const *args, Py_ssize_t nargs", builtin_ctor ? ", PyObject *kwnames" : "", ") {", NIL);
+    else
+      Printv(f->def, linkage, builtin_ctor ? "int " : "PyObject *", wname, "(PyObject *self, PyObject *args", builtin_kwargs, ") {", NIL);
 
     if (builtin) {
       /* Avoid warning if the self parameter is not used. */
@@ -2595,6 +2680,14 @@ public:
       Append(f->code, "}\n");
       if (add_self)
 	Append(f->code, "argc++;\n");
+    } else if (fastcall_dispatch) {
+      if (builtin_ctor)
+	Printf(f->code, "if (!SWIG_Python_CheckNoKeywordNames(kwnames, \"%s\")) SWIG_fail;\n", symname);
+      Printf(f->code, "if (!(argc = SWIG_Python_UnpackArray(args, nargs, \"%s\", 0, %d, argv%s))) SWIG_fail;\n", symname, maxargs, add_self ? "+1" : "");
+      if (add_self)
+	Append(f->code, "argv[0] = self;\n");
+      else
+	Append(f->code, "--argc;\n");
     } else {
       if (builtin_ctor)
 	Printf(f->code, "if (!SWIG_Python_CheckNoKeywords(kwargs, \"%s\")) SWIG_fail;\n", symname);
@@ -2633,7 +2726,7 @@ public:
     Wrapper_print(f, f_wrappers);
     Node *p = Getattr(n, "sym:previousSibling");
     if (!builtin_self && (use_static_method || !builtin))
-      add_method(symname, wname, 0, p);
+      add_method(symname, wname, 0, p, 0, -1, -1, fastcall_dispatch);
 
     /* Create a shadow for this function (if enabled and not in a member function) */
     if (!builtin && shadow && !(shadow & PYSHADOW_MEMBER) && use_static_method) {
@@ -2760,7 +2853,7 @@ public:
     outarg = NewString("");
     kwargs = NewString("");
 
-    int allow_thread = threads_enable(n);
+    int allow_thread = releasegil_enable(n);
 
     Wrapper_add_local(f, "resultobj", "PyObject *resultobj = 0");
 
@@ -2827,8 +2920,24 @@ public:
     bool over_varargs = emit_isvarargs_function(n);
 
     int funpack = fastunpack && !varargs && !over_varargs && !allow_kwargs;
+
+    /* With -fastcall, keyword arguments are unpacked from the argument array too */
+    int fastcall_args = !overname && !varargs && use_fastcall(n);
+    for (p = l; fastcall_args && p; p = nextSibling(p)) {
+      if (Getattr(p, "tmap:in:parse"))
+	fastcall_args = 0;
+    }
+    if (fastcall_args && allow_kwargs)
+      funpack = 1;
+
     int noargs = funpack && (tuple_required == 0 && tuple_arguments == 0);
     int onearg = funpack && (tuple_required == 1 && tuple_arguments == 1);
+    /* METH_NOARGS and METH_O wrappers already get their arguments without a tuple */
+    int fastcall_wrapper = fastcall_args && (allow_kwargs || builtin_ctor || !(noargs || onearg));
+    if (fastcall_wrapper)
+      SetFlag(n, "python:fastcall");
+    else
+      Delattr(n, "python:fastcall");
 
     if (builtin && funpack && !overname && !builtin_ctor) {
       int compactdefargs = ParmList_is_compactdefargs(l);
@@ -2959,10 +3068,10 @@ public:
     /* finish argument marshalling */
     Append(kwargs, " NULL }");
     if (allow_kwargs) {
-      Printv(f->locals, "  char * kwnames[] = ", kwargs, ";\n", NIL);
+      Printv(f->locals, fastcall_wrapper ? "  char * swig_kwlist[] = " : "  char * kwnames[] = ", kwargs, ";\n", NIL);
     }
 
-    if (use_parse || allow_kwargs) {
+    if (use_parse || (allow_kwargs && !fastcall_wrapper)) {
       Printf(parse_args, ":%s\"", iname);
       Printv(parse_args, arglist, ")) SWIG_fail;\n", NIL);
       funpack = 0;
@@ -2978,6 +3087,15 @@ public:
 	    Printv(f->def, linkage, wrap_return, wname, "(PyObject *self, Py_ssize_t nobjs, PyObject **swig_obj) {", NIL);
 	  }
 	  Printf(parse_args, "if ((nobjs < %d) || (nobjs > %d)) SWIG_fail;\n", num_required, num_arguments);
+	} else if (fastcall_wrapper) {
+	  Printv(f->def, linkage, wrap_return, wname, "(PyObject *self, PyObject *const *args, Py_ssize_t nargs", (allow_kwargs || builtin_ctor) ? ", PyObject *kwnames" : "", ") {", NIL);
+	  if (allow_kwargs) {
+	    Printf(parse_args, "if (!SWIG_Python_UnpackKeywords(args, nargs, kwnames, \"%s\", %d, %d, swig_kwlist, %s)) SWIG_fail;\n", iname, num_fixed_arguments, tuple_arguments, noargs ? "0" : "swig_obj");
+	  } else {
+	    if (builtin_ctor)
+	      Printf(parse_args, "if (!SWIG_Python_CheckNoKeywordNames(kwnames, \"%s\")) SWIG_fail;\n", iname);
+	    Printf(parse_args, "if (!SWIG_Python_UnpackArray(args, nargs, \"%s\", %d, %d, %s)) SWIG_fail;\n", iname, num_fixed_arguments, tuple_arguments, noargs ? "0" : "swig_obj");
+	  }
 	} else {
 	  int is_tp_call = Equal(Getattr(n, "feature:python:slot"), "tp_call");
 	  Printv(f->def, linkage, wrap_return, wname, "(PyObject *self, PyObject *args", builtin_kwargs, ") {", NIL);
@@ -3287,7 +3405,7 @@ public:
     /* Now register the function with the interpreter.   */
     if (!Getattr(n, "sym:overloaded")) {
       if (!builtin_self && (use_static_method || !builtin))
-	add_method(iname, wname, allow_kwargs, n, funpack, num_required, num_arguments);
+	add_method(iname, wname, allow_kwargs, n, funpack, num_required, num_arguments, GetFlag(n, "python:fastcall"));
 
       /* Create a shadow for this function (if enabled and not in a member function) */
       if (!builtin && shadow && !(shadow & PYSHADOW_MEMBER) && use_static_method) {
@@ -3304,8 +3422,10 @@ public:
     if (builtin_ctor) {
       if ((director_method || !is_private(n)) && !Getattr(class_members, iname)) {
 	Setattr(class_members, iname, n);
-	if (!builtin_tp_init)
+	if (!builtin_tp_init) {
 	  builtin_tp_init = Swig_name_wrapper(iname);
+	  builtin_tp_init_fastcall = Getattr(n, "sym:overloaded") ? use_fastcall(n) : GetFlag(n, "python:fastcall");
+	}
       }
     }
 
@@ -4101,6 +4221,16 @@ public:
     }
     String *quoted_tp_doc_str = NewStringf("\"%s\"", getSlot(n, "feature:python:tp_doc"));
     String *tp_init = NewString(builtin_tp_init ? Char(builtin_tp_init) : Swig_directorclass(n) ? "0" : "SwigPyBuiltin_BadInit");
+    String *tp_vectorcall = NewString("0");
+    if (builtin_tp_init && builtin_tp_init_fastcall) {
+      // The constructor wrapper takes an argument array, call it from tp_init and, without any tuple, from tp_vectorcall
+      Printf(f, "SWIGPY_FASTCALL_INIT_CLOSURE(%s) /* defines %s_init_closure and %s_vectorcall_closure */\n\n", builtin_tp_init, builtin_tp_init, builtin_tp_init);
+      Append(tp_init, "_init_closure");
+      if (!Getattr(n, "feature:python:tp_init")) {
+	Clear(tp_vectorcall);
+	Printf(tp_vectorcall, "%s_vectorcall_closure", builtin_tp_init);
+      }
+    }
     String *tp_flags = NewString("Py_TPFLAGS_DEFAULT|Py_TPFLAGS_BASETYPE|Py_TPFLAGS_CHECKTYPES");
     String *tp_flags_py3 = NewString("Py_TPFLAGS_DEFAULT|Py_TPFLAGS_BASETYPE");
 
@@ -4193,7 +4323,7 @@ public:
     printSlot(f, getSlot(n, "feature:python:tp_finalize"), "tp_finalize", "destructor");
     Printv(f, "#endif\n", NIL);
     Printv(f, "#if PY_VERSION_HEX >= 0x03080000\n", NIL);
-    printSlot(f, getSlot(n, "feature:python:tp_vectorcall"), "tp_vectorcall", "vectorcallfunc");
+    printSlot(f, getSlot(n, "feature:python:tp_vectorcall", tp_vectorcall), "tp_vectorcall", "vectorcallfunc");
     Printv(f, "#endif\n", NIL);
     Printv(f, "#if (PY_VERSION_HEX >= 0x03080000) && (PY_VERSION_HEX < 0x03090000)\n", NIL);
     printSlot(f, getSlot(), "tp_print");
@@ -4395,6 +4525,7 @@ public:
     Delete(quoted_symname);
     Delete(quoted_tp_doc_str);
     Delete(tp_init);
+    Delete(tp_vectorcall);
     Delete(clientdata_klass);
     Delete(richcompare_func);
     Delete(getset_name);
@@ -4466,6 +4597,10 @@ public:
 	Setattr(n, "python:richcompare", richcompare);
       }
 
+      /* the root proxy classes store 'this' in the slot of SwigPyProxy */
+      if (!builtin && thisslot && Len(base_class) == 0 && !GetFlag(n, "feature:exceptionclass"))
+	Printv(base_class, "_SwigPyProxy", NIL);
+
       /* dealing with abstract base class */
       String *abcs = Getattr(n, "feature:python:abc");
       if (abcs) {
@@ -4605,6 +4740,7 @@ public:
       if (builtin_tp_init) {
 	Delete(builtin_tp_init);
 	builtin_tp_init = 0;
+	builtin_tp_init_fastcall = false;
       }
 
       if (!builtin) {
@@ -4663,7 +4799,7 @@ public:
     int oldshadow;
 
     if (builtin)
-      Swig_save("builtin_memberfunc", n, "python:argcount", NIL);
+      Swig_save("builtin_memberfunc", n, "python:argcount", "python:fastcall", NIL);
 
     /* Create the default member function */
     oldshadow = shadow;		/* Disable shadowing when wrapping member functions */
@@ -4680,8 +4816,13 @@ public:
 	String *wname = Swig_name_wrapper(fullname);
 	Setattr(class_members, symname, n);
 	int argcount = Getattr(n, "python:argcount") ? atoi(Char(Getattr(n, "python:argcount"))) : 2;
+	bool fastcall_wrapper = Getattr(n, "sym:overloaded") ? use_fastcall(n) : GetFlag(n, "python:fastcall");
 	String *ds = have_docstring(n) ? cdocstring(n, AUTODOC_METHOD) : NewString("");
-	if (check_kwargs(n)) {
+	if (fastcall_wrapper) {
+	  // The dispatcher of overloaded methods takes no keyword arguments.
+	  const char *pyflags = check_kwargs(n) && !Getattr(n, "sym:overloaded") ? "METH_FASTCALL|METH_KEYWORDS" : "METH_FASTCALL";
+	  Printf(builtin_methods, "  { \"%s\", (PyCFunction)(void(*)(void))%s, %s, \"%s\" },\n", symname, wname, pyflags, ds);
+	} else if (check_kwargs(n)) {
 	  // Cast via void(*)(void) to suppress GCC -Wcast-function-type
 	  // warning.  Python should always call the function correctly, but
 	  // the Python C API requires us to store it in function pointer of a
@@ -4783,7 +4924,9 @@ public:
 	int funpack = fastunpack && !Getattr(n, "sym:overloaded");
 	String *pyflags = NewString("METH_STATIC|");
 	int argcount = Getattr(n, "python:argcount") ? atoi(Char(Getattr(n, "python:argcount"))) : 2;
-	if (funpack && argcount == 0)
+	if (Getattr(n, "sym:overloaded") ? use_fastcall(n) : GetFlag(n, "python:fastcall"))
+	  Append(pyflags, kw ? "METH_FASTCALL|METH_KEYWORDS" : "METH_FASTCALL");
+	else if (funpack && argcount == 0)
 	  Append(pyflags, "METH_NOARGS");
 	else if (funpack && argcount == 1)
 	  Append(pyflags, "METH_O");
@@ -20,6 +20,20 @@
 #include "swig.h"
 #include "preprocessor.h"
 #include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
 
 static Hash *cpp = 0;		/* C preprocessor data */
 static int include_all = 0;	/* Follow all includes */
@@ -36,6 +50,22 @@ static int macro_level = 0;
 static int macro_start_line = 0;
 static const String * macro_start_file = 0;
 
+static int cpp_generation = 0;	/* Changed whenever macros, included files or pragmas change */
+static int macro_location_uses = 0;	/* __LINE__ and __FILE__ substitutions */
+static int macro_memoize = 0;	/* Memoize complete macro expansions */
+static Hash *macro_memo = 0;
+static int macro_memo_generation = -1;
+static int macro_stats = 0;	/* Collect expansion statistics for -debug-cpp-stats */
+static int macro_expansions = 0;
+static int macro_precompiled_fills = 0;
+static int macro_substitutions = 0;
+static int macro_memo_hits = 0;
+static int macro_memo_misses = 0;
+static clock_t macro_clock = 0;
+static int prelude_cache_hits = 0;	/* Preprocessor_parse_cached() results, also for -debug-cpp-stats */
+static int prelude_cache_misses = 0;
+static int prelude_cache_saves = 0;
+
 /* Test a character to see if it starts an identifier */
 #define isidentifier(c) ((isalpha(c)) || (c == '_') || (c == '$'))
 
@@ -82,6 +112,7 @@ static void copy_location(const DOH *s1, DOH *s2) {
 
 static String *cpp_include(const_String_or_char_ptr fn, int sysfile) {
   String *s = sysfile ? Swig_include_sys(fn) : Swig_include(fn);
+  cpp_generation++;
   if (s && single_include) {
     String *file = Getfile(s);
     if (Getattr(included_files, file)) {
@@ -165,6 +196,8 @@ static String *kpp_FILE = 0;
 static String *kpp_hash_if = 0;
 static String *kpp_hash_elif = 0;
 
+static String *kpp_body = 0;
+
 void Preprocessor_init(void) {
   Hash *s;
 
@@ -205,6 +238,8 @@ void Preprocessor_init(void) {
   kpp_hash_if = NewString("#if");
   kpp_hash_elif = NewString("#elif");
 
+  kpp_body = NewString("*body*");
+
   cpp = NewHash();
   s = NewHash();
   Setattr(cpp, kpp_symbols, s);
@@ -253,6 +288,10 @@ void Preprocessor_delete(void) {
   Delete(kpp_hash_if);
   Delete(kpp_hash_elif);
 
+  Delete(kpp_body);
+  Delete(macro_memo);
+  macro_memo = 0;
+
   Delete(cpp);
   Delete(included_files);
   Preprocessor_expr_delete();
@@ -282,6 +321,46 @@ void Preprocessor_error_as_warning(int a) {
   error_as_warning = a;
 }
 
+/* -----------------------------------------------------------------------------
+ * Preprocessor_memoize()
+ *
+ * Reuse the result of earlier identical macro expansions.
+ * ----------------------------------------------------------------------------- */
+
+void Preprocessor_memoize(int a) {
+  macro_memoize = a;
+}
+
+/* -----------------------------------------------------------------------------
+ * Preprocessor_stats()
+ *
+ * Time macro expansions for Preprocessor_stats_debug().
+ * ----------------------------------------------------------------------------- */
+
+void Preprocessor_stats(int a) {
+  macro_stats = a;
+}
+
+/* -----------------------------------------------------------------------------
+ * Preprocessor_stats_debug()
+ *
+ * Display macro expansion and prelude cache statistics.
+ * ----------------------------------------------------------------------------- */
+
+void Preprocessor_stats_debug(void) {
+  int lookups = macro_memo_hits + macro_memo_misses;
+  Printf(stdout, "---[ preprocessor macro expansion ]------------------------------------------\n");
+  Printf(stdout, "  expansions    : %d\n", macro_expansions);
+  Printf(stdout, "  precompiled   : %d\n", macro_precompiled_fills);
+  Printf(stdout, "  substituted   : %d\n", macro_substitutions);
+  Printf(stdout, "  memo hits     : %d (%d%%)\n", macro_memo_hits, lookups ? (int)(100.0 * macro_memo_hits / lookups) : 0);
+  Printf(stdout, "  memo misses   : %d\n", macro_memo_misses);
+  Printf(stdout, "  memo entries  : %d\n", macro_memo ? Len(macro_memo) : 0);
+  Printf(stdout, "  time          : %.3f s\n", (double) macro_clock / CLOCKS_PER_SEC);
+  Printf(stdout, "  prelude cache : %d hits, %d misses, %d saved\n", prelude_cache_hits, prelude_cache_misses, prelude_cache_saves);
+  Printf(stdout, "-----------------------------------------------------------------------------\n");
+}
+
 
 /* -----------------------------------------------------------------------------
  * Preprocessor_define()
@@ -531,6 +610,7 @@ Hash *Preprocessor_define(const_String_or_char_ptr _str, int swigmacro) {
     Setattr(macro, kpp_swigmacro, "1");
   }
   symbols = Getattr(cpp, kpp_symbols);
+  cpp_generation++;
   if ((m1 = Getattr(symbols, macroname))) {
     if (!Checkattr(m1, kpp_value, macrovalue)) {
       Swig_error(Getfile(macroname), Getline(macroname), "Macro '%s' redefined,\n", macroname);
@@ -568,6 +648,7 @@ void Preprocessor_undef(const_String_or_char_ptr str) {
   assert(cpp);
   symbols = Getattr(cpp, kpp_symbols);
   Delattr(symbols, str);
+  cpp_generation++;
 }
 
 /* -----------------------------------------------------------------------------
@@ -779,7 +860,124 @@ bad:
 }
 
 /* -----------------------------------------------------------------------------
- * expand_macro()
+ * macro_body()
+ *
+ * Returns the precompiled body of a macro taking arguments.  This is a list
+ * alternating literal text and parameter numbers (text, param, text, ..., text)
+ * so that expanding the macro only needs to fill in the expanded arguments.
+ * The list is empty if the body uses #, ##, #@ or `x`, which still need the
+ * textual substitution in expand_macro().
+ * ----------------------------------------------------------------------------- */
+
+static int is_replace_idchar(char c) {
+  /* Identifier characters as matched by DOH_REPLACE_ID */
+  return isalnum((int) c) || (c == '_');
+}
+
+static List *macro_body(Hash *macro) {
+  List *body = Getattr(macro, kpp_body);
+  String *mvalue, *lit;
+  List *margs;
+  const char *v;
+  int i, p, q, len, nargs;
+
+  if (body)
+    return body;
+
+  body = NewList();
+  Setattr(macro, kpp_body, body);
+  Delete(body);
+
+  mvalue = Getattr(macro, kpp_value);
+  margs = Getattr(macro, kpp_args);
+  v = Char(mvalue);
+  len = Len(mvalue);
+  nargs = Len(margs);
+  if (strpbrk(v, "\001\002\003\004\005`"))
+    return body;
+  for (i = 0; i < nargs; i++) {
+    const char *a = Char(Getitem(margs, i));
+    if (!*a)
+      return body;
+    for (; *a; a++) {
+      if (!is_replace_idchar(*a))
+	return body;
+    }
+  }
+
+  lit = NewStringEmpty();
+  p = 0;
+  while (p < len) {
+    if (is_replace_idchar(v[p])) {
+      q = p;
+      while (q < len && is_replace_idchar(v[q]))
+	q++;
+      for (i = 0; i < nargs; i++) {
+	String *aname = Getitem(margs, i);
+	if (Len(aname) == q - p && strncmp(Char(aname), v + p, (size_t) (q - p)) == 0)
+	  break;
+      }
+      if (i < nargs) {
+	String *slot = NewStringf("%d", i);
+	Append(body, lit);
+	Append(body, slot);
+	Delete(lit);
+	Delete(slot);
+	lit = NewStringEmpty();
+      } else {
+	Write(lit, (void *) (v + p), q - p);
+      }
+      p = q;
+    } else {
+      Putc(v[p], lit);
+      p++;
+    }
+  }
+  Append(body, lit);
+  Delete(lit);
+  return body;
+}
+
+/* -----------------------------------------------------------------------------
+ * macro_body_fill()
+ *
+ * Expands a precompiled macro body with the expanded arguments.  Returns 0 if
+ * the arguments could interact with the textual substitution (an argument
+ * containing the name of a later parameter or one of the special tokens), in
+ * which case the result must come from the substitution instead.
+ * ----------------------------------------------------------------------------- */
+
+static String *macro_body_fill(List *body, String *mvalue, List *margs, List *repargs) {
+  String *ns;
+  int i, j, nargs = Len(repargs);
+
+  if (Len(body) == 0 || Tell(mvalue) != Len(mvalue))
+    return 0;
+  for (i = 0; i < nargs; i++) {
+    const char *r = Char(Getitem(repargs, i));
+    if (strpbrk(r, "\001\002\003\004\005`"))
+      return 0;
+    for (j = i + 1; j < nargs; j++) {
+      if (strstr(r, Char(Getitem(margs, j))))
+	return 0;
+    }
+  }
+
+  ns = NewStringEmpty();
+  for (i = 0; i < Len(body); i++) {
+    String *item = Getitem(body, i);
+    if (i % 2)
+      Append(ns, Getitem(repargs, atoi(Char(item))));
+    else
+      Append(ns, item);
+  }
+  Seek(ns, 0, SEEK_END);
+  copy_location(mvalue, ns);
+  return ns;
+}
+
+/* -----------------------------------------------------------------------------
+ * expand_macro_impl()
  *
  * Perform macro expansion and return a new string.  Returns NULL if some sort
  * of error occurred.
@@ -788,9 +986,10 @@ bad:
  * line_file - only used for line/file name when reporting errors
  * ----------------------------------------------------------------------------- */
 
-static String *expand_macro(String *name, List *args, String *line_file) {
-  String *ns;
+static String *expand_macro_impl(String *name, List *args, String *line_file) {
+  String *ns = 0;
   DOH *symbols, *macro, *margs, *mvalue, *temp, *tempa, *e;
+  List *repargs = 0;
   int i, l;
   int isvarargs = 0;
 
@@ -888,125 +1087,141 @@ static String *expand_macro(String *name, List *args, String *line_file) {
     return NewString(name);
   }
 
-  /* Copy the macro value */
-  ns = Copy(mvalue);
-  copy_location(mvalue, ns);
-
-  /* Tag the macro as being expanded.   This is to avoid recursion in
-     macro expansion */
-
-  temp = NewStringEmpty();
-  tempa = NewStringEmpty();
   if (args && margs) {
+    /* Expand the arguments */
+    repargs = NewList();
     l = Len(margs);
     for (i = 0; i < l; i++) {
-      DOH *arg, *aname;
-      String *reparg;
-      arg = Getitem(args, i);	/* Get an argument value */
-      reparg = Preprocessor_replace(arg);
-      aname = Getitem(margs, i);	/* Get macro argument name */
-      if (strstr(Char(ns), "\001")) {
-	/* Try to replace a quoted version of the argument */
-	Clear(temp);
-	Clear(tempa);
-	Printf(temp, "\001%s", aname);
-	Printf(tempa, "\"%s\"", arg);
-	Replace(ns, temp, tempa, DOH_REPLACE_ID_END);
-      }
-      if (strstr(Char(ns), "\002")) {
-	/* Look for concatenation tokens */
-	Clear(temp);
-	Clear(tempa);
-	Printf(temp, "\002%s", aname);
-	Append(tempa, "\002\003");
-	Replace(ns, temp, tempa, DOH_REPLACE_ID_END);
-	Clear(temp);
-	Clear(tempa);
-	Printf(temp, "%s\002", aname);
-	Append(tempa, "\003\002");
-	Replace(ns, temp, tempa, DOH_REPLACE_ID_BEGIN);
-      }
+      String *reparg = Preprocessor_replace(Getitem(args, i));
+      Append(repargs, reparg);
+      Delete(reparg);
+    }
+    ns = macro_body_fill(macro_body(macro), mvalue, margs, repargs);
+    if (ns)
+      macro_precompiled_fills++;
+    else
+      macro_substitutions++;
+  }
 
-      /* Non-standard macro expansion.   The value `x` is replaced by a quoted
-         version of the argument except that if the argument is already quoted
-         nothing happens */
-
-      if (strchr(Char(ns), '`')) {
-	String *rep;
-	char *c;
-	Clear(temp);
-	Printf(temp, "`%s`", aname);
-	c = Char(arg);
-	if (*c == '\"') {
-	  rep = arg;
-	} else {
+  temp = NewStringEmpty();
+  tempa = NewStringEmpty();
+  if (!ns) {
+    /* Copy the macro value */
+    ns = Copy(mvalue);
+    copy_location(mvalue, ns);
+
+    if (args && margs) {
+      l = Len(margs);
+      for (i = 0; i < l; i++) {
+	DOH *arg, *aname;
+	String *reparg;
+	arg = Getitem(args, i);	/* Get an argument value */
+	reparg = Getitem(repargs, i);
+	aname = Getitem(margs, i);	/* Get macro argument name */
+	if (strstr(Char(ns), "\001")) {
+	  /* Try to replace a quoted version of the argument */
+	  Clear(temp);
 	  Clear(tempa);
+	  Printf(temp, "\001%s", aname);
 	  Printf(tempa, "\"%s\"", arg);
-	  rep = tempa;
+	  Replace(ns, temp, tempa, DOH_REPLACE_ID_END);
+	}
+	if (strstr(Char(ns), "\002")) {
+	  /* Look for concatenation tokens */
+	  Clear(temp);
+	  Clear(tempa);
+	  Printf(temp, "\002%s", aname);
+	  Append(tempa, "\002\003");
+	  Replace(ns, temp, tempa, DOH_REPLACE_ID_END);
+	  Clear(temp);
+	  Clear(tempa);
+	  Printf(temp, "%s\002", aname);
+	  Append(tempa, "\003\002");
+	  Replace(ns, temp, tempa, DOH_REPLACE_ID_BEGIN);
 	}
-	Replace(ns, temp, rep, DOH_REPLACE_ANY);
-      }
 
-      /* Non-standard mangle expansions.  
-         The #@Name is replaced by mangle_arg(Name). */
-      if (strstr(Char(ns), "\004")) {
-	String *marg = Swig_string_mangle(arg);
-	Clear(temp);
-	Printf(temp, "\004%s", aname);
-	Replace(ns, temp, marg, DOH_REPLACE_ID_END);
-	Delete(marg);
-      }
-      if (strstr(Char(ns), "\005")) {
-	String *marg = Swig_string_mangle(arg);
-	Clear(temp);
-	Clear(tempa);
-	Printf(temp, "\005%s", aname);
-	Printf(tempa, "\"%s\"", marg);
-	Replace(ns, temp, tempa, DOH_REPLACE_ID_END);
-	Delete(marg);
-      }
+	/* Non-standard macro expansion.   The value `x` is replaced by a quoted
+	   version of the argument except that if the argument is already quoted
+	   nothing happens */
+
+	if (strchr(Char(ns), '`')) {
+	  String *rep;
+	  char *c;
+	  Clear(temp);
+	  Printf(temp, "`%s`", aname);
+	  c = Char(arg);
+	  if (*c == '\"') {
+	    rep = arg;
+	  } else {
+	    Clear(tempa);
+	    Printf(tempa, "\"%s\"", arg);
+	    rep = tempa;
+	  }
+	  Replace(ns, temp, rep, DOH_REPLACE_ANY);
+	}
+
+	/* Non-standard mangle expansions.  
+	   The #@Name is replaced by mangle_arg(Name). */
+	if (strstr(Char(ns), "\004")) {
+	  String *marg = Swig_string_mangle(arg);
+	  Clear(temp);
+	  Printf(temp, "\004%s", aname);
+	  Replace(ns, temp, marg, DOH_REPLACE_ID_END);
+	  Delete(marg);
+	}
+	if (strstr(Char(ns), "\005")) {
+	  String *marg = Swig_string_mangle(arg);
+	  Clear(temp);
+	  Clear(tempa);
+	  Printf(temp, "\005%s", aname);
+	  Printf(tempa, "\"%s\"", marg);
+	  Replace(ns, temp, tempa, DOH_REPLACE_ID_END);
+	  Delete(marg);
+	}
 
-      if (isvarargs && i == l - 1 && Len(arg) == 0) {
-	/* Zero length varargs macro argument.   We search for commas that might appear before and nuke them */
-	char *a, *s, *t, *name;
-	int namelen;
-	s = Char(ns);
-	name = Char(aname);
-	namelen = Len(aname);
-	a = strstr(s, name);
-	while (a) {
-	  char ca = a[namelen];
-	  if (!isidchar((int) ca)) {
-	    /* Matched the entire vararg name, not just a prefix */
-	    if (a > s) {
-	      t = a - 1;
-	      if (*t == '\002') {
-		t--;
-		while (t >= s) {
-		  if (isspace((int) *t))
-		    t--;
-		  else if (*t == ',') {
-		    *t = ' ';
-		  } else
-		    break;
+	if (isvarargs && i == l - 1 && Len(arg) == 0) {
+	  /* Zero length varargs macro argument.   We search for commas that might appear before and nuke them */
+	  char *a, *s, *t, *name;
+	  int namelen;
+	  s = Char(ns);
+	  name = Char(aname);
+	  namelen = Len(aname);
+	  a = strstr(s, name);
+	  while (a) {
+	    char ca = a[namelen];
+	    if (!isidchar((int) ca)) {
+	      /* Matched the entire vararg name, not just a prefix */
+	      if (a > s) {
+		t = a - 1;
+		if (*t == '\002') {
+		  t--;
+		  while (t >= s) {
+		    if (isspace((int) *t))
+		      t--;
+		    else if (*t == ',') {
+		      *t = ' ';
+		    } else
+		      break;
+		  }
 		}
 	      }
 	    }
+	    a = strstr(a + namelen, name);
 	  }
-	  a = strstr(a + namelen, name);
 	}
+	/*      Replace(ns, aname, arg, DOH_REPLACE_ID); */
+	Replace(ns, aname, reparg, DOH_REPLACE_ID);	/* Replace expanded args */
+	Replace(ns, "\003", arg, DOH_REPLACE_ANY);	/* Replace unexpanded arg */
       }
-      /*      Replace(ns, aname, arg, DOH_REPLACE_ID); */
-      Replace(ns, aname, reparg, DOH_REPLACE_ID);	/* Replace expanded args */
-      Replace(ns, "\003", arg, DOH_REPLACE_ANY);	/* Replace unexpanded arg */
-      Delete(reparg);
     }
+    Replace(ns, "\002", "", DOH_REPLACE_ANY);	/* Get rid of concatenation tokens */
+    Replace(ns, "\001", "#", DOH_REPLACE_ANY);	/* Put # back (non-standard C) */
+    Replace(ns, "\004", "#@", DOH_REPLACE_ANY);	/* Put # back (non-standard C) */
   }
-  Replace(ns, "\002", "", DOH_REPLACE_ANY);	/* Get rid of concatenation tokens */
-  Replace(ns, "\001", "#", DOH_REPLACE_ANY);	/* Put # back (non-standard C) */
-  Replace(ns, "\004", "#@", DOH_REPLACE_ANY);	/* Put # back (non-standard C) */
+  Delete(repargs);
 
-  /* Expand this macro even further */
+  /* Tag the macro as being expanded.   This is to avoid recursion in
+     macro expansion */
   Setattr(macro, kpp_expanded, "1");
 
   e = Preprocessor_replace(ns);
@@ -1046,6 +1261,77 @@ static String *expand_macro(String *name, List *args, String *line_file) {
   return e;
 }
 
+/* -----------------------------------------------------------------------------
+ * expand_macro()
+ *
+ * Wrapper around expand_macro_impl() which gathers the -debug-cpp-stats
+ * statistics and memoizes outermost expansions when enabled.  An expansion is
+ * only reused if nothing it could depend on has changed since: no macro was
+ * defined or undefined, no file included and no pragma processed.  Expansions
+ * that issue a diagnostic, use __LINE__ or __FILE__ or change the state of the
+ * preprocessor themselves are not memoized.
+ * ----------------------------------------------------------------------------- */
+
+static String *expand_macro(String *name, List *args, String *line_file) {
+  String *e;
+  String *key = 0;
+  clock_t start = 0;
+  int generation = cpp_generation;
+  int location_uses = macro_location_uses;
+  int defined_operator = expand_defined_operator;
+  int nerrors = 0, nwarnings = 0;
+
+  macro_expansions++;
+  if (macro_level > 0 || !(macro_memoize || macro_stats))
+    return expand_macro_impl(name, args, line_file);
+
+  if (macro_stats)
+    start = clock();
+  if (macro_memoize) {
+    int i;
+    if (!macro_memo)
+      macro_memo = NewHash();
+    if (macro_memo_generation != cpp_generation) {
+      Clear(macro_memo);
+      macro_memo_generation = cpp_generation;
+    }
+    key = NewStringf("%d %s", defined_operator, name);
+    if (args) {
+      Putc('(', key);
+      for (i = 0; i < Len(args); i++) {
+	String *arg = Getitem(args, i);
+	Printf(key, "%d:%s", Len(arg), arg);
+      }
+    }
+    e = Getattr(macro_memo, key);
+    if (e) {
+      macro_memo_hits++;
+      Delete(key);
+      if (macro_stats)
+	macro_clock += clock() - start;
+      return Copy(e);
+    }
+    macro_memo_misses++;
+    nerrors = Swig_error_count();
+    nwarnings = Swig_warn_count();
+  }
+
+  e = expand_macro_impl(name, args, line_file);
+
+  if (key) {
+    if (e && generation == cpp_generation && location_uses == macro_location_uses && defined_operator == expand_defined_operator &&
+	nerrors == Swig_error_count() && nwarnings == Swig_warn_count()) {
+      String *memo = Copy(e);
+      Setattr(macro_memo, key, memo);
+      Delete(memo);
+    }
+    Delete(key);
+  }
+  if (macro_stats)
+    macro_clock += clock() - start;
+  return e;
+}
+
 /* -----------------------------------------------------------------------------
  * DOH *Preprocessor_replace(DOH *s)
  *
@@ -1178,11 +1464,14 @@ static DOH *Preprocessor_replace(DOH *s) {
 	  state = 0;
 	  break;
 	} else if (Equal(kpp_LINE, id)) {
+	  macro_location_uses++;
 	  Printf(ns, "%d", macro_level > 0 ? macro_start_line : Getline(s));
 	  state = 0;
 	  break;
 	} else if (Equal(kpp_FILE, id)) {
-	  String *fn = Copy(macro_level > 0 ? macro_start_file : Getfile(s));
+	  String *fn;
+	  macro_location_uses++;
+	  fn = Copy(macro_level > 0 ? macro_start_file : Getfile(s));
 	  Replaceall(fn, "\\", "\\\\");
 	  Printf(ns, "\"%s\"", fn);
 	  Delete(fn);
@@ -1274,9 +1563,12 @@ static DOH *Preprocessor_replace(DOH *s) {
     if (Equal(kpp_defined, id)) {
       Swig_error(Getfile(s), Getline(s), "No arguments given to defined()\n");
     } else if (Equal(kpp_LINE, id)) {
+      macro_location_uses++;
       Printf(ns, "%d", macro_level > 0 ? macro_start_line : Getline(s));
     } else if (Equal(kpp_FILE, id)) {
-      String *fn = Copy(macro_level > 0 ? macro_start_file : Getfile(s));
+      String *fn;
+      macro_location_uses++;
+      fn = Copy(macro_level > 0 ? macro_start_file : Getfile(s));
       Replaceall(fn, "\\", "\\\\");
       Printf(ns, "\"%s\"", fn);
       Delete(fn);
@@ -1816,6 +2108,7 @@ String *Preprocessor_parse(String *s) {
 	  Delete(fn);
 	}
       } else if (Equal(id, kpp_pragma)) {
+	cpp_generation++;
 	if (Strncmp(value, "SWIG ", 5) == 0) {
 	  char *c = Char(value) + 5;
 	  while (*c && (isspace((int) *c)))
@@ -2109,3 +2402,528 @@ String *Preprocessor_parse(String *s) {
 
   return ns;
 }
+
+/* -----------------------------------------------------------------------------
+ * Prelude cache
+ *
+ * Every run starts by preprocessing the same SWIG library prelude (swig.swg and
+ * the target language configuration file). Preprocessor_parse_cached() stores
+ * the result of doing so in a cache directory, together with the state the
+ * prelude leaves behind in the preprocessor: the macro table, the included
+ * files and the dependencies reported by -M.
+ *
+ * The cache file name is a hash of everything the result depends on: the SWIG
+ * version, the prelude text, the include path, the preprocessor options, the
+ * warning filter and the macros defined beforehand (-D options, language and
+ * predefined macros). The complete key is stored in the file and compared on
+ * load. The modification time and size of every file read by the prelude are
+ * recorded and must match before a cached result is used. So must the absence
+ * of every file the prelude looked for and didn't find, including in the
+ * current directory, as a file created there would now be read instead.
+ * Other changes to the include directories, such as generated headers, don't
+ * invalidate the result.
+ *
+ * The SWIGOPT macros installed for the command line options are left out of
+ * the key, as they include per-run values such as the output file name. A
+ * result is only cached if the prelude files never mention them, and the
+ * current values are kept when a cached result is restored.
+ *
+ * A result is not cached if preprocessing the prelude issued any error or
+ * warning or changed the warning filter, so a cache hit never hides a
+ * diagnostic.
+ * ----------------------------------------------------------------------------- */
+
+#define CACHE_MAGIC "SWIGCPP1"
+#define CACHE_MAGIC_LEN 8
+
+#define CACHE_MACRO_ARGS 1
+#define CACHE_MACRO_VARARGS 2
+#define CACHE_MACRO_SWIGMACRO 4
+
+typedef struct {
+  const char *p;
+  const char *end;
+  int ok;
+  Hash *files;			/* Shared file name objects for the restored locations */
+} CacheReader;
+
+static int cache_option_macro(const String *name) {
+  return strncmp(Char(name), "SWIGOPT", 7) == 0;
+}
+
+static void cache_put_int(String *b, long long v) {
+  unsigned long long u = (unsigned long long) v;
+  unsigned char c[8];
+  int i;
+  for (i = 0; i < 8; i++) {
+    c[i] = (unsigned char) (u >> (8 * i));
+  }
+  Write(b, c, 8);
+}
+
+static void cache_put_str(String *b, const_String_or_char_ptr s) {
+  const char *c = Char(s);
+  int len = DohCheck(s) ? Len(s) : (int) strlen(c);
+  cache_put_int(b, len);
+  Write(b, (void *) c, len);
+}
+
+static void cache_put_loc(String *b, DOH *obj) {
+  String *file = Getfile(obj);
+  if (file) {
+    cache_put_int(b, 1);
+    cache_put_str(b, file);
+  } else {
+    cache_put_int(b, 0);
+  }
+  cache_put_int(b, Getline(obj));
+}
+
+static void cache_put_macro(String *b, Hash *macro) {
+  String *name = Getattr(macro, kpp_name);
+  String *value = Getattr(macro, kpp_value);
+  List *args = Getattr(macro, kpp_args);
+  int flags = 0;
+
+  if (args)
+    flags |= CACHE_MACRO_ARGS;
+  if (Getattr(macro, kpp_varargs))
+    flags |= CACHE_MACRO_VARARGS;
+  if (Getattr(macro, kpp_swigmacro))
+    flags |= CACHE_MACRO_SWIGMACRO;
+
+  cache_put_str(b, name);
+  cache_put_loc(b, name);
+  cache_put_int(b, flags);
+  if (args) {
+    Iterator ai;
+    cache_put_int(b, Len(args));
+    for (ai = First(args); ai.item; ai = Next(ai)) {
+      cache_put_str(b, ai.item);
+    }
+  }
+  cache_put_str(b, value);
+  cache_put_loc(b, value);
+  cache_put_loc(b, macro);
+}
+
+/* Write all macros other than the SWIGOPT ones */
+static void cache_put_macros(String *b, Hash *symbols) {
+  Iterator ki;
+  int n = 0;
+  for (ki = First(symbols); ki.key; ki = Next(ki)) {
+    if (!cache_option_macro(ki.key))
+      n++;
+  }
+  cache_put_int(b, n);
+  for (ki = First(symbols); ki.key; ki = Next(ki)) {
+    if (!cache_option_macro(ki.key))
+      cache_put_macro(b, ki.item);
+  }
+}
+
+static long long cache_get_int(CacheReader *r) {
+  unsigned long long u = 0;
+  int i;
+  if (!r->ok || r->end - r->p < 8) {
+    r->ok = 0;
+    return 0;
+  }
+  for (i = 0; i < 8; i++) {
+    u |= ((unsigned long long) (unsigned char) r->p[i]) << (8 * i);
+  }
+  r->p += 8;
+  return (long long) u;
+}
+
+static String *cache_get_str(CacheReader *r) {
+  long long len = cache_get_int(r);
+  String *s;
+  if (!r->ok || len < 0 || len > r->end - r->p) {
+    r->ok = 0;
+    return NewStringEmpty();
+  }
+  s = NewStringEmpty();
+  Write(s, (void *) r->p, (int) len);
+  r->p += len;
+  return s;
+}
+
+static void cache_get_loc(CacheReader *r, DOH *obj) {
+  if (cache_get_int(r)) {
+    String *file = cache_get_str(r);
+    String *shared = Getattr(r->files, file);
+    if (!shared) {
+      Setattr(r->files, file, file);
+      shared = file;
+    }
+    Setfile(obj, shared);
+    Delete(file);
+  }
+  Setline(obj, (int) cache_get_int(r));
+}
+
+static Hash *cache_get_macro(CacheReader *r) {
+  Hash *macro = NewHash();
+  String *name = cache_get_str(r);
+  String *value;
+  int flags;
+
+  cache_get_loc(r, name);
+  Setattr(macro, kpp_name, name);
+  flags = (int) cache_get_int(r);
+  if (flags & CACHE_MACRO_ARGS) {
+    List *args = NewList();
+    long long i, nargs = cache_get_int(r);
+    for (i = 0; r->ok && i < nargs; i++) {
+      String *arg = cache_get_str(r);
+      Append(args, arg);
+      Delete(arg);
+    }
+    Setattr(macro, kpp_args, args);
+    Delete(args);
+    if (flags & CACHE_MACRO_VARARGS) {
+      Setattr(macro, kpp_varargs, "1");
+    }
+  }
+  value = cache_get_str(r);
+  cache_get_loc(r, value);
+  Setattr(macro, kpp_value, value);
+  cache_get_loc(r, macro);
+  if (flags & CACHE_MACRO_SWIGMACRO) {
+    Setattr(macro, kpp_swigmacro, "1");
+  }
+  Delete(name);
+  Delete(value);
+  return macro;
+}
+
+/* Modification time in nanoseconds where the file system records them, so that
+   rewriting a header within a second of the cached run is noticed */
+static long long cache_mtime(const struct stat *st) {
+#if defined(__APPLE__)
+  return (long long) st->st_mtimespec.tv_sec * 1000000000 + st->st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+  return (long long) st->st_mtime;
+#else
+  return (long long) st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+#endif
+}
+
+/* Record the state of a file: modification time and size, or -1 if it does not exist */
+static void cache_put_stat(String *b, String *path) {
+  struct stat st;
+  cache_put_str(b, path);
+  if (stat(Char(path), &st) == 0) {
+    cache_put_int(b, cache_mtime(&st));
+    cache_put_int(b, (long long) st.st_size);
+  } else {
+    cache_put_int(b, -1);
+    cache_put_int(b, -1);
+  }
+}
+
+static int cache_check_stat(CacheReader *r) {
+  String *path = cache_get_str(r);
+  long long mtime = cache_get_int(r);
+  long long size = cache_get_int(r);
+  struct stat st;
+  int match;
+  if (!r->ok) {
+    match = 0;
+  } else if (stat(Char(path), &st) == 0) {
+    match = (mtime == cache_mtime(&st)) && (size == (long long) st.st_size);
+  } else {
+    match = (mtime == -1);
+  }
+  Delete(path);
+  return match;
+}
+
+static String *cache_key(String *s) {
+  String *key = NewStringEmpty();
+  Hash *symbols = Getattr(cpp, kpp_symbols);
+  List *spath = Swig_search_path();
+  String *filter = Swig_warnfilter_state();
+  Iterator ki;
+
+  cache_put_str(key, Swig_package_version());
+  cache_put_int(key, include_all);
+  cache_put_int(key, import_all);
+  cache_put_int(key, ignore_missing);
+  cache_put_int(key, single_include);
+  cache_put_int(key, error_as_warning);
+  cache_put_str(key, filter);
+  cache_put_int(key, Len(spath));
+  for (ki = First(spath); ki.item; ki = Next(ki)) {
+    cache_put_str(key, ki.item);
+  }
+  cache_put_macros(key, symbols);
+  cache_put_str(key, s);
+
+  Delete(filter);
+  Delete(spath);
+  return key;
+}
+
+/* FNV-1a hash of the key, used as the cache file name */
+static String *cache_file(const_String_or_char_ptr cachedir, String *key) {
+  const unsigned char *c = (const unsigned char *) Char(key);
+  int i, len = Len(key);
+  unsigned long long h = 0xcbf29ce484222325ULL;
+  for (i = 0; i < len; i++) {
+    h ^= c[i];
+    h *= 0x100000001b3ULL;
+  }
+  return NewStringf("%s%sswig-cpp-%08lx%08lx.cache", cachedir, SWIG_FILE_DELIMITER, (unsigned long) (h >> 32), (unsigned long) (h & 0xffffffffUL));
+}
+
+static char *cache_map(String *path, size_t *size) {
+  char *data = 0;
+#ifndef _WIN32
+  struct stat st;
+  int fd = open(Char(path), O_RDONLY);
+  if (fd < 0)
+    return 0;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    void *m = mmap(0, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (m != MAP_FAILED) {
+      data = (char *) m;
+      *size = (size_t) st.st_size;
+    }
+  }
+  close(fd);
+#else
+  FILE *f = fopen(Char(path), "rb");
+  long n;
+  if (!f)
+    return 0;
+  if (fseek(f, 0, SEEK_END) == 0 && (n = ftell(f)) > 0 && fseek(f, 0, SEEK_SET) == 0) {
+    data = (char *) malloc((size_t) n);
+    if (data && fread(data, 1, (size_t) n, f) != (size_t) n) {
+      free(data);
+      data = 0;
+    }
+    *size = (size_t) n;
+  }
+  fclose(f);
+#endif
+  return data;
+}
+
+static void cache_unmap(char *data, size_t size) {
+#ifndef _WIN32
+  munmap(data, size);
+#else
+  (void) size;
+  free(data);
+#endif
+}
+
+/* Restore a cached prelude. Returns the preprocessed text or 0 if the cache entry is missing or stale */
+static String *cache_load(String *path, String *key) {
+  size_t size = 0;
+  char *data = cache_map(path, &size);
+  CacheReader r;
+  String *ns = 0;
+  String *ckey;
+  Hash *symbols;
+  Hash *files;
+  List *deps;
+  Iterator ki;
+  long long i, n;
+
+  if (!data)
+    return 0;
+  r.p = data;
+  r.end = data + size;
+  r.ok = 1;
+  r.files = NewHash();
+  if (size < CACHE_MAGIC_LEN || memcmp(data, CACHE_MAGIC, CACHE_MAGIC_LEN) != 0) {
+    r.ok = 0;
+  } else {
+    r.p += CACHE_MAGIC_LEN;
+  }
+  ckey = cache_get_str(&r);
+  if (r.ok && Cmp(ckey, key) != 0)
+    r.ok = 0;
+  Delete(ckey);
+
+  /* Files and directories the cached result depends on */
+  n = cache_get_int(&r);
+  for (i = 0; r.ok && i < n; i++) {
+    if (!cache_check_stat(&r))
+      r.ok = 0;
+  }
+
+  if (r.ok) {
+    ns = cache_get_str(&r);
+    symbols = NewHash();
+    for (ki = First(Getattr(cpp, kpp_symbols)); ki.key; ki = Next(ki)) {
+      if (cache_option_macro(ki.key))
+	Setattr(symbols, ki.key, ki.item);
+    }
+    n = cache_get_int(&r);
+    for (i = 0; r.ok && i < n; i++) {
+      Hash *macro = cache_get_macro(&r);
+      Setattr(symbols, Getattr(macro, kpp_name), macro);
+      Delete(macro);
+    }
+    files = NewHash();
+    n = cache_get_int(&r);
+    for (i = 0; r.ok && i < n; i++) {
+      String *file = cache_get_str(&r);
+      Setattr(files, file, file);
+      Delete(file);
+    }
+    deps = NewList();
+    n = cache_get_int(&r);
+    for (i = 0; r.ok && i < n; i++) {
+      String *dep = cache_get_str(&r);
+      Append(deps, dep);
+      Delete(dep);
+    }
+    n = cache_get_int(&r);
+    if (r.ok && r.p == r.end) {
+      Setattr(cpp, kpp_symbols, symbols);
+      cpp_generation++;
+      for (ki = First(files); ki.key; ki = Next(ki)) {
+	Setattr(included_files, ki.key, ki.item);
+      }
+      if (!dependencies) {
+	dependencies = NewList();
+      }
+      for (ki = First(deps); ki.item; ki = Next(ki)) {
+	Append(dependencies, ki.item);
+      }
+      error_as_warning = (int) n;
+    } else {
+      Delete(ns);
+      ns = 0;
+    }
+    Delete(symbols);
+    Delete(files);
+    Delete(deps);
+  }
+  Delete(r.files);
+  cache_unmap(data, size);
+  return ns;
+}
+
+/* Check whether the prelude text or any file it read refers to a SWIGOPT macro */
+static int cache_uses_options(String *s, int ndeps) {
+  int i, uses = strstr(Char(s), "SWIGOPT") != 0;
+  for (i = ndeps; !uses && dependencies && i < Len(dependencies); i++) {
+    FILE *f = fopen(Char(Getitem(dependencies, i)), "rb");
+    String *text;
+    if (!f)
+      return 1;
+    text = Swig_read_file(f);
+    fclose(f);
+    uses = !text || strstr(Char(text), "SWIGOPT") != 0;
+    Delete(text);
+  }
+  return uses;
+}
+
+/* Write a cache entry for the prelude just preprocessed. The first ndeps dependencies predate the prelude */
+static void cache_save(const_String_or_char_ptr cachedir, String *path, String *key, String *ns, int ndeps, Hash *probes) {
+  String *b = NewStringEmpty();
+  Hash *symbols = Getattr(cpp, kpp_symbols);
+  String *tmp;
+  Iterator ki;
+  FILE *f;
+  int i, ndependencies = dependencies ? Len(dependencies) : 0;
+
+  Write(b, (void *) CACHE_MAGIC, CACHE_MAGIC_LEN);
+  cache_put_str(b, key);
+
+  cache_put_int(b, (ndependencies - ndeps) + Len(probes));
+  for (i = ndeps; i < ndependencies; i++) {
+    cache_put_stat(b, Getitem(dependencies, i));
+  }
+  for (ki = First(probes); ki.key; ki = Next(ki)) {
+    cache_put_stat(b, ki.key);
+  }
+
+  cache_put_str(b, ns);
+  cache_put_macros(b, symbols);
+  cache_put_int(b, Len(included_files));
+  for (ki = First(included_files); ki.key; ki = Next(ki)) {
+    cache_put_str(b, ki.key);
+  }
+  cache_put_int(b, ndependencies - ndeps);
+  for (i = ndeps; i < ndependencies; i++) {
+    cache_put_str(b, Getitem(dependencies, i));
+  }
+  cache_put_int(b, error_as_warning);
+
+  /* Write to a temporary file and rename it so that concurrent runs never see a partial entry */
+  tmp = NewStringf("%s.%ld", path, (long) getpid());
+  f = fopen(Char(tmp), "wb");
+  if (!f && errno == ENOENT) {
+    /* Create the cache directory on first use */
+#ifdef _WIN32
+    _mkdir(Char(cachedir));
+#else
+    mkdir(Char(cachedir), 0777);
+#endif
+    f = fopen(Char(tmp), "wb");
+  }
+  if (f) {
+    int written = fwrite(Char(b), 1, (size_t) Len(b), f) == (size_t) Len(b);
+    if (fclose(f) == 0 && written) {
+#ifdef _WIN32
+      remove(Char(path));
+#endif
+      if (rename(Char(tmp), Char(path)) != 0)
+	remove(Char(tmp));
+    } else {
+      remove(Char(tmp));
+    }
+  }
+  Delete(tmp);
+  Delete(b);
+}
+
+/* -----------------------------------------------------------------------------
+ * Preprocessor_parse_cached()
+ *
+ * Preprocesses the prelude s like Preprocessor_parse(), reusing the result of an
+ * earlier run stored in cachedir when it is still valid.
+ * ----------------------------------------------------------------------------- */
+
+String *Preprocessor_parse_cached(String *s, const_String_or_char_ptr cachedir) {
+  String *key = cache_key(s);
+  String *path = cache_file(cachedir, key);
+  String *ns = cache_load(path, key);
+
+  if (ns) {
+    prelude_cache_hits++;
+  } else {
+    int nerrors = Swig_error_count();
+    int nwarnings = Swig_warn_count();
+    int ndeps = dependencies ? Len(dependencies) : 0;
+    String *filter = Swig_warnfilter_state();
+    String *filter_after;
+    Hash *probes = NewHash();
+    Hash *previous_probes = Swig_file_probes(probes);
+
+    prelude_cache_misses++;
+    ns = Preprocessor_parse(s);
+    Swig_file_probes(previous_probes);
+    filter_after = Swig_warnfilter_state();
+    if (Swig_error_count() == nerrors && Swig_warn_count() == nwarnings && Cmp(filter, filter_after) == 0 && !cache_uses_options(s, ndeps)) {
+      cache_save(cachedir, path, key, ns, ndeps, probes);
+      prelude_cache_saves++;
+    }
+    Delete(probes);
+    Delete(filter_after);
+    Delete(filter);
+  }
+  copy_location(s, ns);
+
+  Delete(path);
+  Delete(key);
+  return ns;
+}
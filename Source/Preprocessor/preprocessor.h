@@ -26,10 +26,14 @@ extern "C" {
   extern void Preprocessor_init(void);
   extern void Preprocessor_delete(void);
   extern String *Preprocessor_parse(String *s);
+  extern String *Preprocessor_parse_cached(String *s, const_String_or_char_ptr cachedir);
   extern void Preprocessor_include_all(int);
   extern void Preprocessor_import_all(int);
   extern void Preprocessor_ignore_missing(int);
   extern void Preprocessor_error_as_warning(int);
+  extern void Preprocessor_memoize(int);
+  extern void Preprocessor_stats(int);
+  extern void Preprocessor_stats_debug(void);
   extern List *Preprocessor_depend(void);
   extern void Preprocessor_expr_init(void);
   extern void Preprocessor_expr_delete(void);
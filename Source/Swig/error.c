@@ -164,6 +164,17 @@ int Swig_error_count(void) {
   return nerrors;
 }
 
+/* -----------------------------------------------------------------------------
+ * Swig_error_count_add()
+ *
+ * Adds errors reported elsewhere, for example by a worker process, to the
+ * number of errors received.
+ * ----------------------------------------------------------------------------- */
+
+void Swig_error_count_add(int n) {
+  nerrors += n;
+}
+
 /* -----------------------------------------------------------------------------
  * Swig_error_silent()
  *
@@ -228,6 +239,16 @@ void Swig_warnall(void) {
   warnall = 1;
 }
 
+/* -----------------------------------------------------------------------------
+ * Swig_warnfilter_state()
+ *
+ * Return a new string describing the current warning filter settings
+ * ----------------------------------------------------------------------------- */
+
+String *Swig_warnfilter_state(void) {
+  return NewStringf("%d%s", warnall, filter ? filter : "");
+}
+
 
 /* ----------------------------------------------------------------------------- 
  * Swig_warn_count()
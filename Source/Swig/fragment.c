@@ -23,6 +23,12 @@
 static Hash *fragments = 0;
 static Hash *looking_fragments = 0;
 static int debug = 0;
+static int mark = 0;
+
+/* Markers wrapped around emitted fragments by Swig_fragment_mark() */
+#define FRAGMENT_MARK_BEGIN '\001'
+#define FRAGMENT_MARK_NAME_END '\002'
+#define FRAGMENT_MARK_END '\003'
 
 
 /* -----------------------------------------------------------------------------
@@ -149,11 +155,15 @@ void Swig_fragment_emit(Node *n) {
 	} else {
 	  if (debug)
 	    Printf(stdout, "emitting subfragment %s %s\n", name, section);
+	  if (mark)
+	    Printf(f, "%c%s%c", FRAGMENT_MARK_BEGIN, name, FRAGMENT_MARK_NAME_END);
 	  if (debug)
 	    Printf(f, "/* begin fragment %s */\n", name);
 	  Printf(f, "%s\n", code);
 	  if (debug)
 	    Printf(f, "/* end fragment %s */\n\n", name);
+	  if (mark)
+	    Printf(f, "%c", FRAGMENT_MARK_END);
 	  Setattr(fragments, name, "ignore");
 	  Delattr(looking_fragments, name);
 	}
@@ -186,3 +196,53 @@ void Swig_fragment_emit(Node *n) {
   }
   Delete(t);
 }
+
+/* -----------------------------------------------------------------------------
+ * Swig_fragment_mark()
+ *
+ * When on, the code of every emitted fragment is wrapped in markers naming the
+ * fragment.  Output produced separately, for example by worker processes, can
+ * then be merged with Swig_fragment_unmark().
+ * ----------------------------------------------------------------------------- */
+
+void Swig_fragment_mark(int on) {
+  mark = on;
+}
+
+/* -----------------------------------------------------------------------------
+ * Swig_fragment_unmark()
+ *
+ * Returns a copy of s with the fragment markers removed.  Only the first copy
+ * of each fragment is kept, fragments already in the emitted hash are dropped.
+ * The names of the fragments kept are added to emitted.
+ * ----------------------------------------------------------------------------- */
+
+String *Swig_fragment_unmark(const_String_or_char_ptr s, Hash *emitted) {
+  String *result;
+  char *c = Char(s);
+  char *buffer = (char *)Malloc(strlen(c) + 1);
+  char *out = buffer;
+  while (*c) {
+    if (*c == FRAGMENT_MARK_BEGIN) {
+      char *name = c + 1;
+      char *code = strchr(name, FRAGMENT_MARK_NAME_END);
+      char *end = code ? strchr(code, FRAGMENT_MARK_END) : 0;
+      if (end) {
+	String *key = NewStringWithSize(name, (int)(code - name));
+	if (!Getattr(emitted, key)) {
+	  Setattr(emitted, key, "1");
+	  memcpy(out, code + 1, end - code - 1);
+	  out += end - code - 1;
+	}
+	Delete(key);
+	c = end + 1;
+	continue;
+      }
+    }
+    *out++ = *c++;
+  }
+  *out = 0;
+  result = NewString(buffer);
+  Free(buffer);
+  return result;
+}
@@ -20,6 +20,7 @@ static String *lastpath = 0;	        /* Last file that was included */
 static List   *pdirectories = 0;        /* List of pushed directories  */
 static int     dopush = 1;		/* Whether to push directories */
 static int file_debug = 0;
+static Hash   *probes = 0;		/* Files looked for but not found, see Swig_file_probes() */
 
 /* This functions determine whether to push/pop dirs in the preprocessor */
 void Swig_set_push_dir(int push) {
@@ -173,6 +174,11 @@ static FILE *Swig_open_file(const_String_or_char_ptr name, int sysfile, int use_
     Printf(stdout, "  Open: %s\n", filename);
   }
   f = fopen(Char(filename), "r");
+  if (!f && probes) {
+    String *probe = Copy(filename);
+    Setattr(probes, probe, probe);
+    Delete(probe);
+  }
   if (!f && use_include_path) {
     spath = Swig_search_path_any(sysfile);
     ilen = Len(spath);
@@ -182,6 +188,11 @@ static FILE *Swig_open_file(const_String_or_char_ptr name, int sysfile, int use_
       f = fopen(Char(filename), "r");
       if (f)
 	break;
+      if (probes) {
+	String *probe = Copy(filename);
+	Setattr(probes, probe, probe);
+	Delete(probe);
+      }
     }
     Delete(spath);
   }
@@ -200,6 +211,21 @@ static FILE *Swig_open_file(const_String_or_char_ptr name, int sysfile, int use_
   return f;
 }
 
+/* -----------------------------------------------------------------------------
+ * Swig_file_probes()
+ *
+ * Records the path of every file Swig_open() and Swig_include() look for but
+ * don't find as a key of the hash h, until called again with 0.  A file created
+ * at one of these paths later on would be found instead of the file that was
+ * read.  Returns the previous hash.
+ * ----------------------------------------------------------------------------- */
+
+Hash *Swig_file_probes(Hash *h) {
+  Hash *previous = probes;
+  probes = h;
+  return previous;
+}
+
 /* Open a file - searching the include paths to find it */
 FILE *Swig_include_open(const_String_or_char_ptr name) {
   return Swig_open_file(name, 0, 1);
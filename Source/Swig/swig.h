@@ -200,6 +200,7 @@ extern "C" {
   extern void SwigType_inherit_scope(Typetab *scope);
   extern Typetab *SwigType_pop_scope(void);
   extern Typetab *SwigType_set_scope(Typetab *h);
+  extern int SwigType_typesystem_generation(void);
   extern void SwigType_print_scope(void);
   extern SwigType *SwigType_typedef_resolve(const SwigType *t);
   extern SwigType *SwigType_typedef_resolve_all(const SwigType *t);
@@ -230,6 +231,8 @@ extern "C" {
   extern Symtab *Swig_symbol_getscope(const_String_or_char_ptr symname);
   extern Symtab *Swig_symbol_global_scope(void);
   extern Symtab *Swig_symbol_current(void);
+  extern int Swig_symbol_generation(void);
+  extern void Swig_symbol_cache_debug(void);
   extern Symtab *Swig_symbol_popscope(void);
   extern Node *Swig_symbol_add(const_String_or_char_ptr symname, Node *node);
   extern void Swig_symbol_cadd(const_String_or_char_ptr symname, Node *node);
@@ -346,10 +349,12 @@ extern int        ParmList_is_compactdefargs(ParmList *p);
   extern void Swig_warning(int num, const_String_or_char_ptr filename, int line, const char *fmt, ...);
   extern void Swig_error(const_String_or_char_ptr filename, int line, const char *fmt, ...);
   extern int Swig_error_count(void);
+  extern void Swig_error_count_add(int n);
   extern void Swig_error_silent(int s);
   extern void Swig_warnfilter(const_String_or_char_ptr wlist, int val);
   extern void Swig_warnall(void);
   extern int Swig_warn_count(void);
+  extern String *Swig_warnfilter_state(void);
   extern void Swig_error_msg_format(ErrorMessageFormat format);
   extern void Swig_diagnostic(const_String_or_char_ptr filename, int line, const char *fmt, ...);
   extern String *Swig_stringify_with_location(DOH *object);
@@ -408,6 +413,7 @@ extern int        ParmList_is_compactdefargs(ParmList *p);
   extern void Swig_typemap_clear_apply(ParmList *pattern);
   extern void Swig_typemap_replace_embedded_typemap(String *s, Node *file_line_node);
   extern void Swig_typemap_debug(void);
+  extern void Swig_typemap_search_cache_debug(void);
   extern void Swig_typemap_search_debug_set(void);
   extern void Swig_typemap_used_debug_set(void);
   extern void Swig_typemap_register_debug_set(void);
@@ -422,6 +428,8 @@ extern int        ParmList_is_compactdefargs(ParmList *p);
   extern void Swig_fragment_register(Node *fragment);
   extern void Swig_fragment_emit(String *name);
   extern void Swig_fragment_clear(String *section);
+  extern void Swig_fragment_mark(int on);
+  extern String *Swig_fragment_unmark(const_String_or_char_ptr s, Hash *emitted);
 
 /* --- Extension support --- */
 
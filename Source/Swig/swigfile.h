@@ -31,6 +31,7 @@ extern String *Swig_file_basename(const_String_or_char_ptr filename);
 extern String *Swig_file_filename(const_String_or_char_ptr filename);
 extern String *Swig_file_dirname(const_String_or_char_ptr filename);
 extern void   Swig_file_debug_set(void);
+extern Hash   *Swig_file_probes(Hash *h);
 
 /* Delimiter used in accessing files and directories */
 
@@ -173,6 +173,26 @@ static Hash *ccurrent = 0;	/* The current c symbol table hash */
 static Hash *current_symtab = 0;	/* Current symbol table node */
 static Hash *symtabs = 0;	/* Hash of all symbol tables by fully-qualified name */
 static Hash *global_scope = 0;	/* Global scope */
+static int symbol_generation = 0;	/* Bumped whenever C symbols or scopes are added */
+static int inherit_generation = 0;	/* Bumped whenever a scope is inherited */
+
+/* Lookup caches, see symbol_lookup() and symbol_template_qualify() */
+static String *lookup_miss = 0;	/* Cached result for a failed lookup */
+static List *lookup_symtabs = 0;	/* Symbol tables holding cached lookups */
+static List *chain_symtabs = 0;	/* Symbol tables holding a flattened inheritance chain */
+static Hash *qualify_cache = 0;
+static int lookup_cache_generation = -1;
+static int chain_cache_generation = -1;
+static int qualify_cache_generation = -1;
+static int lookup_depth = 0;
+static int lookups = 0;
+static int lookup_hits = 0;
+static int lookup_negative_hits = 0;
+static int lookup_misses = 0;
+static int lookup_flushes = 0;
+static int lookup_chains = 0;
+static int qualify_hits = 0;
+static int qualify_misses = 0;
 
 static int use_inherit = 1;
 
@@ -290,6 +310,10 @@ void Swig_symbol_init(void) {
   Setattr(symtabs, "", current_symtab);
   Delete(current_symtab);
   global_scope = current_symtab;
+
+  lookup_miss = NewString("");
+  lookup_symtabs = NewList();
+  chain_symtabs = NewList();
 }
 
 /* -----------------------------------------------------------------------------
@@ -310,6 +334,7 @@ void Swig_symbol_setscopename(const_String_or_char_ptr name) {
   /* Save a reference to this scope */
   Setattr(symtabs, qname, current_symtab);
   Delete(qname);
+  symbol_generation++;
 }
 
 /* -----------------------------------------------------------------------------
@@ -470,6 +495,38 @@ Symtab *Swig_symbol_current(void) {
   return current_symtab;
 }
 
+/* -----------------------------------------------------------------------------
+ * Swig_symbol_generation()
+ *
+ * Returns a counter that changes whenever the C symbol tables change, that is,
+ * when a C symbol, scope name, alias or inherited scope is added.  Used by
+ * callers caching results derived from C symbol lookups.
+ * ----------------------------------------------------------------------------- */
+
+int Swig_symbol_generation(void) {
+  return symbol_generation;
+}
+
+/* -----------------------------------------------------------------------------
+ * Swig_symbol_cache_debug()
+ *
+ * Display C symbol lookup cache statistics.
+ * ----------------------------------------------------------------------------- */
+
+void Swig_symbol_cache_debug(void) {
+  int qualifies = qualify_hits + qualify_misses;
+  Printf(stdout, "---[ symbol lookup cache ]--------------------------------------------------\n");
+  Printf(stdout, "  lookups        : %d\n", lookups);
+  Printf(stdout, "  hits           : %d (%d%%)\n", lookup_hits, lookups ? (int)(100.0 * lookup_hits / lookups) : 0);
+  Printf(stdout, "  negative hits  : %d (%d%%)\n", lookup_negative_hits, lookups ? (int)(100.0 * lookup_negative_hits / lookups) : 0);
+  Printf(stdout, "  misses         : %d\n", lookup_misses);
+  Printf(stdout, "  invalidations  : %d\n", lookup_flushes);
+  Printf(stdout, "  chains built   : %d\n", lookup_chains);
+  Printf(stdout, "  qualifications : %d\n", qualifies);
+  Printf(stdout, "  qualify hits   : %d (%d%%)\n", qualify_hits, qualifies ? (int)(100.0 * qualify_hits / qualifies) : 0);
+  Printf(stdout, "-----------------------------------------------------------------------------\n");
+}
+
 /* -----------------------------------------------------------------------------
  * Swig_symbol_alias()
  *
@@ -486,6 +543,7 @@ void Swig_symbol_alias(const_String_or_char_ptr aliasname, Symtab *s) {
   }
   if (!Getattr(symtabs, qname)) {
     Setattr(symtabs, qname, s);
+    symbol_generation++;
   }
   Delete(qname);
 }
@@ -519,6 +577,8 @@ void Swig_symbol_inherit(Symtab *s) {
       return;			/* Already inherited */
   }
   Append(inherit, s);
+  symbol_generation++;
+  inherit_generation++;
 }
 
 /* -----------------------------------------------------------------------------
@@ -561,6 +621,8 @@ void Swig_symbol_cadd(const_String_or_char_ptr name, Node *n) {
 #ifdef SWIG_DEBUG
   Printf(stderr, "symbol_cadd %s %p\n", name, n);
 #endif
+  /* After the lookups above, so that their cached results are discarded */
+  symbol_generation++;
   cn = Getattr(ccurrent, name);
 
   if (cn && (Getattr(cn, "sym:typename"))) {
@@ -1019,13 +1081,153 @@ static Node *_symbol_lookup(const String *name, Symtab *symtab, int (*check) (No
   return 0;
 }
 
+/* -----------------------------------------------------------------------------
+ * symbol_chain()
+ *
+ * Returns the scopes inherited by symtab, directly or indirectly, flattened into
+ * the order in which _symbol_lookup() searches them.  Each scope appears once.
+ * The list is kept on the symbol table until a scope is next inherited.
+ * ----------------------------------------------------------------------------- */
+
+static void symbol_chain_build(Symtab *symtab, List *chain) {
+  List *inherit = Getattr(symtab, "inherit");
+  int i, j, len, clen;
+  if (!inherit || Getmark(symtab))
+    return;
+  Setmark(symtab, 1);
+  len = Len(inherit);
+  for (i = 0; i < len; i++) {
+    Symtab *s = Getitem(inherit, i);
+    if (Getmark(s))
+      continue;
+    clen = Len(chain);
+    for (j = 0; j < clen; j++) {
+      if (Getitem(chain, j) == s)
+	break;
+    }
+    if (j == clen)
+      Append(chain, s);
+    symbol_chain_build(s, chain);
+  }
+  Setmark(symtab, 0);
+}
+
+static List *symbol_chain(Symtab *symtab) {
+  List *chain;
+  if (chain_cache_generation != inherit_generation) {
+    Iterator it;
+    for (it = First(chain_symtabs); it.item; it = Next(it))
+      Delattr(it.item, "$symchain");
+    Clear(chain_symtabs);
+    chain_cache_generation = inherit_generation;
+  }
+  chain = Getattr(symtab, "$symchain");
+  if (!chain) {
+    chain = NewList();
+    symbol_chain_build(symtab, chain);
+    Setattr(symtab, "$symchain", chain);
+    Delete(chain);
+    Append(chain_symtabs, symtab);
+    lookup_chains++;
+  }
+  return chain;
+}
+
+/* -----------------------------------------------------------------------------
+ * symbol_lookup()
+ *
+ * Front end to _symbol_lookup() caching the result of a lookup in a symbol table,
+ * including failed lookups, on the symbol table itself.  The caches are discarded
+ * whenever the C symbol tables change (symbol_generation).  Only lookups without
+ * a check function or with symbol_no_constructor() are cached, as the result
+ * of other check functions may depend on more than the symbol tables.
+ *
+ * Names that are not templates are looked up directly in the flattened chain of
+ * inherited scopes rather than by recursion.  Lookups of template names may
+ * themselves perform lookups while _symbol_lookup() has symbol tables marked.
+ * Any lookup made while _symbol_lookup() runs, from the cached or uncached path,
+ * bypasses the cache, so a result computed with marked tables is never cached.
+ * ----------------------------------------------------------------------------- */
+
+static int symbol_no_constructor(Node *n);
+
+static Node *symbol_lookup_uncached(const String *name, Symtab *symtab, int (*check) (Node *n)) {
+  Node *n;
+  lookup_depth++;
+  n = _symbol_lookup(name, symtab, check);
+  lookup_depth--;
+  return n;
+}
+
+static Node *symbol_lookup_cached(const String *name, Symtab *symtab, int (*check) (Node *n)) {
+  const char *cachename = check ? "$symcache:check" : "$symcache";
+  Hash *cache;
+  Node *n = 0;
+  String *key;
+
+  lookups++;
+  if (lookup_cache_generation != symbol_generation) {
+    Iterator it;
+    if (Len(lookup_symtabs))
+      lookup_flushes++;
+    for (it = First(lookup_symtabs); it.item; it = Next(it)) {
+      Delattr(it.item, "$symcache");
+      Delattr(it.item, "$symcache:check");
+    }
+    Clear(lookup_symtabs);
+    lookup_cache_generation = symbol_generation;
+  }
+  cache = Getattr(symtab, cachename);
+  if (cache) {
+    n = Getattr(cache, name);
+    if (n) {
+      if (n == lookup_miss) {
+	lookup_negative_hits++;
+	return 0;
+      }
+      lookup_hits++;
+      return n;
+    }
+  } else {
+    cache = NewHash();
+    Setattr(symtab, cachename, cache);
+    Delete(cache);
+    Append(lookup_symtabs, symtab);
+  }
+
+  lookup_misses++;
+  if (SwigType_istemplate(name)) {
+    n = symbol_lookup_uncached(name, symtab, check);
+  } else {
+    n = Getattr(Getattr(symtab, "csymtab"), name);
+    if (!n || (check && !check(n))) {
+      List *chain = symbol_chain(symtab);
+      int i, len = Len(chain);
+      n = 0;
+      for (i = 0; i < len; i++) {
+	n = Getattr(Getattr(Getitem(chain, i), "csymtab"), name);
+	if (n && (!check || check(n)))
+	  break;
+	n = 0;
+      }
+    }
+  }
+
+  /* The name may be modified by the caller later on, so the cache needs its own copy */
+  key = Copy(name);
+  Setattr(cache, key, n ? n : lookup_miss);
+  Delete(key);
+  return n;
+}
+
 static Node *symbol_lookup(const_String_or_char_ptr name, Symtab *symtab, int (*check) (Node *n)) {
   Node *n = 0;
+  int cached = use_inherit && lookup_depth == 0 && (!check || check == symbol_no_constructor);
   if (DohCheck(name)) {
-    n = _symbol_lookup(name, symtab, check);
+    n = cached ? symbol_lookup_cached(name, symtab, check) : symbol_lookup_uncached(name, symtab, check);
   } else {
     String *sname = NewString(name);
-    n = _symbol_lookup(sname, symtab, check);
+    n = cached ? symbol_lookup_cached(sname, symtab, check) : symbol_lookup_uncached(sname, symtab, check);
     Delete(sname);
   }
   return n;
@@ -1511,10 +1713,14 @@ Node *Swig_symbol_isoverloaded(Node *n) {
  * symbol_template_qualify()
  *
  * Internal function to create a fully qualified type name for templates
+ *
+ * Results are cached by the scope they were qualified in and the type.  The scope
+ * is identified by its symbol table (or node) rather than by its unqualified name,
+ * as different scopes may share a name, and the cache is discarded whenever the
+ * C symbol tables change, as qualification of a type can change when symbols are
+ * added later on.
  * ----------------------------------------------------------------------------- */
 
-/* This cache produces problems with OSS, don't active it */
-/* #define SWIG_TEMPLATE_QUALIFY_CACHE */
 static SwigType *symbol_template_qualify(const SwigType *e, Symtab *st) {
   String *tprefix, *tsuffix;
   SwigType *qprefix;
@@ -1522,21 +1728,22 @@ static SwigType *symbol_template_qualify(const SwigType *e, Symtab *st) {
   Node *tempn;
   Symtab *tscope;
   Iterator ti;
-#ifdef SWIG_TEMPLATE_QUALIFY_CACHE
-  static Hash *qualify_cache = 0;
-  String *scopetype = st ? NewStringf("%s::%s", Getattr(st, "name"), e)
-      : NewStringf("%s::%s", Swig_symbol_getscopename(), e);
-  if (!qualify_cache) {
+  String *scopetype;
+  String *cres;
+
+  if (!qualify_cache || qualify_cache_generation != symbol_generation) {
+    Delete(qualify_cache);
     qualify_cache = NewHash();
+    qualify_cache_generation = symbol_generation;
   }
-  if (scopetype) {
-    String *cres = Getattr(qualify_cache, scopetype);
-    if (cres) {
-      Delete(scopetype);
-      return Copy(cres);
-    }
+  scopetype = NewStringf("%p::%s", st ? st : current_symtab, e);
+  cres = Getattr(qualify_cache, scopetype);
+  if (cres) {
+    qualify_hits++;
+    Delete(scopetype);
+    return Copy(cres);
   }
-#endif
+  qualify_misses++;
 
   tprefix = SwigType_templateprefix(e);
   tsuffix = SwigType_templatesuffix(e);
@@ -1571,10 +1778,12 @@ static SwigType *symbol_template_qualify(const SwigType *e, Symtab *st) {
 #ifdef SWIG_DEBUG
   Printf(stderr, "symbol_temp_qual %s %s\n", e, qprefix);
 #endif
-#ifdef SWIG_TEMPLATE_QUALIFY_CACHE
-  Setattr(qualify_cache, scopetype, qprefix);
+  if (qualify_cache_generation == symbol_generation) {
+    String *cval = Copy(qprefix);
+    Setattr(qualify_cache, scopetype, cval);
+    Delete(cval);
+  }
   Delete(scopetype);
-#endif
 
   return qprefix;
 }
@@ -24,6 +24,14 @@ static int typemaps_used_debug = 0;
 static int typemap_register_debug = 0;
 static int in_typemap_search_multi = 0;
 
+/* typemap_search() cache, see typemap_search() */
+static Hash *typemap_search_cache = 0;
+static int typemap_generation = 0;	/* Bumped whenever a typemap is added, copied, applied or cleared */
+static int typemap_search_cache_generation = -1;
+static int typemap_search_cache_hits = 0;
+static int typemap_search_cache_misses = 0;
+static int typemap_search_cache_flushes = 0;
+
 static void replace_embedded_typemap(String *s, ParmList *parm_sublist, Wrapper *f, Node *file_line_node);
 
 /* -----------------------------------------------------------------------------
@@ -153,6 +161,7 @@ static void set_typemap(const SwigType *type, Hash **tmhash) {
 
 void Swig_typemap_init(void) {
   typemaps = NewHash();
+  typemap_generation++;
 }
 
 static String *typemap_method_name(const_String_or_char_ptr tmap_method) {
@@ -204,6 +213,8 @@ static void typemap_register(const_String_or_char_ptr tmap_method, ParmList *par
       Swig_print_node(parms);
   }
 
+  typemap_generation++;
+
   tm_method = typemap_method_name(tmap_method);
 
   /* Register the first type in the parameter list */
@@ -414,6 +425,7 @@ void Swig_typemap_clear(const_String_or_char_ptr tmap_method, ParmList *parms) {
       Delattr(tm, "code");
       Delattr(tm, "locals");
       Delattr(tm, "kwargs");
+      typemap_generation++;
     }
   }
   Delete(multi_tmap_method);
@@ -467,6 +479,8 @@ int Swig_typemap_apply(ParmList *src, ParmList *dest) {
     dp = nextSibling(dp);
   }
 
+  typemap_generation++;
+
   /* make sure a typemap node exists for the last destination node */
   type = Getattr(lastdp, "type");
   tm = get_typemap(type);
@@ -611,6 +625,7 @@ void Swig_typemap_clear_apply(Parm *parms) {
 	  for (ki2 = First(h); ki2.key; ki2 = Next(ki2)) {
 	    Delattr(h, ki2.key);
 	  }
+	  typemap_generation++;
 	}
       }
     }
@@ -715,14 +730,14 @@ static int is_function_node(Node* node) {
 }
 
 /* -----------------------------------------------------------------------------
- * typemap_search()
+ * typemap_search_impl()
  *
  * Search for a typemap match. This is where the typemap pattern matching rules 
  * are implemented... tries to find the most specific typemap that includes a 
  * 'code' attribute.
  * ----------------------------------------------------------------------------- */
 
-static Hash *typemap_search(const_String_or_char_ptr tmap_method, SwigType *type, const_String_or_char_ptr name, const_String_or_char_ptr qualifiedname, SwigType **matchtype, Node *node) {
+static Hash *typemap_search_impl(const_String_or_char_ptr tmap_method, SwigType *type, const_String_or_char_ptr name, const_String_or_char_ptr qualifiedname, SwigType **matchtype, Node *node) {
   Hash *result = 0;
   Hash *tm;
   Hash *backup = 0;
@@ -838,6 +853,63 @@ ret_result:
 }
 
 
+/* -----------------------------------------------------------------------------
+ * typemap_search()
+ *
+ * Memoizing front end to typemap_search_impl().  Results, including failed
+ * searches, are cached by typemap method, type, name, qualified name, whether
+ * the node is a function (for func_only typemaps) and the current C symbol
+ * table.  The search also depends on typedef resolution and symbol lookups, so
+ * the cache is discarded whenever a typemap is added or removed, or the type
+ * system or C symbol tables change.  The cache is bypassed when displaying
+ * typemap search debug information.
+ * ----------------------------------------------------------------------------- */
+
+static Hash *typemap_search(const_String_or_char_ptr tmap_method, SwigType *type, const_String_or_char_ptr name, const_String_or_char_ptr qualifiedname, SwigType **matchtype, Node *node) {
+  Hash *result;
+  Hash *entry;
+  String *key;
+  SwigType *mtype = 0;
+  int generation;
+
+  if (typemap_search_debug && (in_typemap_search_multi == 0))
+    return typemap_search_impl(tmap_method, type, name, qualifiedname, matchtype, node);
+
+  generation = typemap_generation + SwigType_typesystem_generation() + Swig_symbol_generation();
+  if (!typemap_search_cache || generation != typemap_search_cache_generation) {
+    if (typemap_search_cache)
+      typemap_search_cache_flushes++;
+    Delete(typemap_search_cache);
+    typemap_search_cache = NewHash();
+    typemap_search_cache_generation = generation;
+  }
+
+  key = NewStringf("%s|%s|%s|%s|%d|%p", tmap_method, type, name ? name : "", qualifiedname ? qualifiedname : "", is_function_node(node), Swig_symbol_current());
+  entry = Getattr(typemap_search_cache, key);
+  if (entry) {
+    typemap_search_cache_hits++;
+    if (matchtype)
+      *matchtype = Copy(Getattr(entry, "matchtype"));
+    Delete(key);
+    return Getattr(entry, "typemap");
+  }
+
+  typemap_search_cache_misses++;
+  result = typemap_search_impl(tmap_method, type, name, qualifiedname, &mtype, node);
+  entry = NewHash();
+  if (result)
+    Setattr(entry, "typemap", result);
+  if (mtype)
+    Setattr(entry, "matchtype", mtype);
+  Setattr(typemap_search_cache, key, entry);
+  if (matchtype)
+    *matchtype = Copy(mtype);
+  Delete(mtype);
+  Delete(entry);
+  Delete(key);
+  return result;
+}
+
 /* -----------------------------------------------------------------------------
  * typemap_search_multi()
  *
@@ -1640,7 +1712,7 @@ static String *Swig_typemap_lookup_impl(const_String_or_char_ptr tmap_method, No
 
 String *Swig_typemap_lookup_out(const_String_or_char_ptr tmap_method, Node *node, const_String_or_char_ptr lname, Wrapper *f, String *actioncode) {
   assert(actioncode);
-  assert(Cmp(tmap_method, "out") == 0);
+  assert(Strncmp(tmap_method, "out", 3) == 0); /* "out" or a variant of it, such as "out_fast" */
   return Swig_typemap_lookup_impl(tmap_method, node, lname, f, actioncode);
 }
 
@@ -2209,6 +2281,23 @@ void Swig_typemap_debug(void) {
 }
 
 
+/* -----------------------------------------------------------------------------
+ * Swig_typemap_search_cache_debug()
+ *
+ * Display typemap search cache statistics.
+ * ----------------------------------------------------------------------------- */
+
+void Swig_typemap_search_cache_debug(void) {
+  int total = typemap_search_cache_hits + typemap_search_cache_misses;
+  Printf(stdout, "---[ typemap search cache ]-------------------------------------------------\n");
+  Printf(stdout, "  searches      : %d\n", total);
+  Printf(stdout, "  hits          : %d (%d%%)\n", typemap_search_cache_hits, total ? (int)(100.0 * typemap_search_cache_hits / total) : 0);
+  Printf(stdout, "  misses        : %d\n", typemap_search_cache_misses);
+  Printf(stdout, "  invalidations : %d\n", typemap_search_cache_flushes);
+  Printf(stdout, "  entries       : %d\n", typemap_search_cache ? Len(typemap_search_cache) : 0);
+  Printf(stdout, "-----------------------------------------------------------------------------\n");
+}
+
 /* -----------------------------------------------------------------------------
  * Swig_typemap_search_debug_set()
  *
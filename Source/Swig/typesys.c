@@ -158,6 +158,7 @@ static Hash *scopes = 0;	/* Hash table containing fully qualified scopes */
 static Hash *typedef_resolve_cache = 0;
 static Hash *typedef_all_cache = 0;
 static Hash *typedef_qualified_cache = 0;
+static int typesystem_generation = 0;	/* Bumped whenever the caches above are flushed */
 
 static Typetab *SwigType_find_scope(Typetab *s, const SwigType *nameprefix);
 
@@ -184,6 +185,19 @@ static void flush_cache(void) {
   typedef_resolve_cache = 0;
   typedef_all_cache = 0;
   typedef_qualified_cache = 0;
+  typesystem_generation++;
+}
+
+/* -----------------------------------------------------------------------------
+ * SwigType_typesystem_generation()
+ *
+ * Returns a counter that changes whenever a typedef, class or scope is added
+ * to the type system or the current scope changes.  Used by callers caching
+ * results derived from typedef resolution.
+ * ----------------------------------------------------------------------------- */
+
+int SwigType_typesystem_generation(void) {
+  return typesystem_generation;
 }
 
 /* Initialize the scoping system */
@@ -351,6 +365,7 @@ void SwigType_inherit_scope(Typetab *scope) {
       return;
   }
   Append(inherits, scope);
+  typesystem_generation++;
 }
 
 /* -----------------------------------------------------------------------------
@@ -1303,6 +1318,7 @@ int SwigType_typedef_using(const_String_or_char_ptr name) {
 
   /* We set up a typedef  B --> A::B */
   Setattr(current_typetab, base, name);
+  typesystem_generation++;
 
   /* Find the scope name where the symbol is defined */
   td = SwigType_typedef_resolve(name);
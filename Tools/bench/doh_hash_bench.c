@@ -0,0 +1,92 @@
+/* -----------------------------------------------------------------------------
+ * This file is part of SWIG, which is licensed as a whole under version 3
+ * (or any later version) of the GNU General Public License. Some additional
+ * terms also apply to certain portions of SWIG. The full details of the SWIG
+ * license and copyrights can be found in the LICENSE and COPYRIGHT files
+ * included with the SWIG source code as distributed by the SWIG developers
+ * and at https://www.swig.org/legal.html.
+ *
+ * doh_hash_bench.c
+ *
+ *     Microbenchmark for DOH Hash attribute access.  Builds parse tree like
+ *     nodes and times Setattr/Getattr with C string literal keys (which go
+ *     through key interning) and with String keys.
+ *
+ *     Usage: doh_hash_bench [iterations]
+ * ----------------------------------------------------------------------------- */
+
+#include "doh.h"
+
+#include <string.h>
+#include <time.h>
+
+static const char *const keys[] = {
+  "name", "type", "decl", "sym:name", "value", "parms", "storage", "nodeType",
+  "kind", "code", "access", "sym:symtab", "sym:overloaded", "feature:ignore",
+  "tmap:in", "wrap:action", "uname", "throws", "abstracts", "parentNode"
+};
+#define NKEYS ((int)(sizeof(keys)/sizeof(keys[0])))
+#define NNODES 1000
+
+static double elapsed(clock_t start) {
+  return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void report(const char *what, long ops, double secs) {
+  printf("%-28s %12ld ops %8.3f s %10.1f Mops/s\n", what, ops, secs, secs > 0 ? ops / secs / 1e6 : 0.0);
+}
+
+int main(int argc, char *argv[]) {
+  DOH *nodes[NNODES];
+  DOH *skeys[NKEYS];
+  DOH *value = NewString("value");
+  long iterations = argc > 1 ? atol(argv[1]) : 200;
+  long i, found = 0;
+  int n, k;
+  clock_t start;
+
+  for (k = 0; k < NKEYS; k++)
+    skeys[k] = NewString(keys[k]);
+  for (n = 0; n < NNODES; n++)
+    nodes[n] = NewHash();
+
+  start = clock();
+  for (i = 0; i < iterations; i++) {
+    for (n = 0; n < NNODES; n++) {
+      for (k = 0; k < NKEYS; k++)
+	Setattr(nodes[n], keys[k], value);
+    }
+  }
+  report("Setattr (char * key)", iterations * NNODES * NKEYS, elapsed(start));
+
+  start = clock();
+  for (i = 0; i < iterations; i++) {
+    for (n = 0; n < NNODES; n++) {
+      for (k = 0; k < NKEYS; k++)
+	found += Getattr(nodes[n], keys[k]) != 0;
+    }
+  }
+  report("Getattr (char * key)", iterations * NNODES * NKEYS, elapsed(start));
+
+  start = clock();
+  for (i = 0; i < iterations; i++) {
+    for (n = 0; n < NNODES; n++) {
+      for (k = 0; k < NKEYS; k++)
+	found += Getattr(nodes[n], skeys[k]) != 0;
+    }
+  }
+  report("Getattr (String key)", iterations * NNODES * NKEYS, elapsed(start));
+
+  start = clock();
+  for (i = 0; i < iterations; i++) {
+    for (n = 0; n < NNODES; n++)
+      found += Getattr(nodes[n], "no:such:attribute") != 0;
+  }
+  report("Getattr (missing key)", iterations * NNODES, elapsed(start));
+
+  if (found != 2 * iterations * NNODES * NKEYS) {
+    printf("Unexpected lookup results: %ld\n", found);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,139 @@
+/* -----------------------------------------------------------------------------
+ * This file is part of SWIG, which is licensed as a whole under version 3
+ * (or any later version) of the GNU General Public License. Some additional
+ * terms also apply to certain portions of SWIG. The full details of the SWIG
+ * license and copyrights can be found in the LICENSE and COPYRIGHT files
+ * included with the SWIG source code as distributed by the SWIG developers
+ * and at https://www.swig.org/legal.html.
+ *
+ * doh_rope_bench.c
+ *
+ *     Microbenchmark for generating output into a String versus a Rope, the
+ *     way language modules fill their output sections.  Each variant writes
+ *     the same wrapper like text and dumps it to a file; the files must be
+ *     identical.
+ *
+ *     Usage: doh_rope_bench [megabytes]
+ * ----------------------------------------------------------------------------- */
+
+#include "doh.h"
+
+#include <string.h>
+#include <time.h>
+
+static double elapsed(clock_t start) {
+  return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void report(const char *what, long bytes, double secs) {
+  printf("%-28s %12ld bytes %8.3f s %10.1f MB/s\n", what, bytes, secs, secs > 0 ? bytes / secs / 1e6 : 0.0);
+}
+
+/* Writes n functions of generated code to out */
+static void generate(DOH *out, long n) {
+  DOH *code = NewString("  arg1 = (Foo *)SE_THIS_OBJECT<Foo>(s);\n  SE_PRECONDITION2(arg1, false, \"Invalid Native Object\");\n");
+  long i;
+  for (i = 0; i < n; i++) {
+    Printf(out, "static bool js_module_Foo_method%ld(se::State& s)\n{\n", i);
+    Printv(out, code, "  const auto& args = s.args();\n", NIL);
+    Putc('}', out);
+    Putc('\n', out);
+    Write(out, "\n", 1);
+  }
+  Delete(code);
+}
+
+static int dump_to(DOH *s, const char *filename) {
+  DOH *name = NewString(filename);
+  DOH *f = NewFile(name, "wb", 0);
+  Delete(name);
+  if (!f)
+    return -1;
+  Printv(f, "// begin\n", s, "// end\n", NIL);
+  Delete(f);
+  return 0;
+}
+
+static int same_file(const char *a, const char *b) {
+  FILE *fa = fopen(a, "rb");
+  FILE *fb = fopen(b, "rb");
+  int same = fa && fb;
+  while (same) {
+    int ca = fgetc(fa);
+    int cb = fgetc(fb);
+    if (ca != cb)
+      same = 0;
+    if (ca == EOF || cb == EOF)
+      break;
+  }
+  if (fa)
+    fclose(fa);
+  if (fb)
+    fclose(fb);
+  return same;
+}
+
+int main(int argc, char *argv[]) {
+  long size = (argc > 1 ? atol(argv[1]) : 16) * 1024 * 1024;
+  long n = size / 150;	/* about 150 bytes per function */
+  DOH *s;
+  DOH *r;
+  DOH *f;
+  DOH *name;
+  clock_t start;
+  int failed = 0;
+
+  start = clock();
+  s = NewStringEmpty();
+  generate(s, n);
+  dump_to(s, "doh_rope_bench_string.out");
+  report("String", Len(s), elapsed(start));
+  Delete(s);
+
+  start = clock();
+  r = NewRope();
+  generate(r, n);
+  dump_to(r, "doh_rope_bench_rope.out");
+  report("Rope", Len(r), elapsed(start));
+  Delete(r);
+  if (!same_file("doh_rope_bench_string.out", "doh_rope_bench_rope.out")) {
+    printf("Rope output differs\n");
+    failed = 1;
+  }
+
+  start = clock();
+  r = NewRope();
+  RopeSpill(r, 1024 * 1024);
+  generate(r, n);
+  s = NewRope();
+  Printv(s, r, NIL);
+  dump_to(s, "doh_rope_bench_spill.out");
+  report("Rope (spilled, copied)", Len(s), elapsed(start));
+  Delete(s);
+  Delete(r);
+  if (!same_file("doh_rope_bench_string.out", "doh_rope_bench_spill.out")) {
+    printf("Spilled rope output differs\n");
+    failed = 1;
+  }
+
+  start = clock();
+  name = NewString("doh_rope_bench_stream.out");
+  f = NewFile(name, "wb", 0);
+  Delete(name);
+  if (!f)
+    return 1;
+  Printv(f, "// begin\n", NIL);
+  r = NewRope();
+  RopeStream(r, f);
+  generate(r, n);
+  Printv(f, r, "// end\n", NIL);
+  report("Rope (streamed)", (long) Tell(f), elapsed(start));
+  Delete(r);
+  Delete(f);
+  if (!same_file("doh_rope_bench_string.out", "doh_rope_bench_stream.out")) {
+    printf("Streamed rope output differs\n");
+    failed = 1;
+  }
+
+  return failed;
+}
@@ -0,0 +1,190 @@
+/* -----------------------------------------------------------------------------
+ * This file is part of SWIG, which is licensed as a whole under version 3
+ * (or any later version) of the GNU General Public License. Some additional
+ * terms also apply to certain portions of SWIG. The full details of the SWIG
+ * license and copyrights can be found in the LICENSE and COPYRIGHT files
+ * included with the SWIG source code as distributed by the SWIG developers
+ * and at https://www.swig.org/legal.html.
+ *
+ * swig_init_bench.c
+ *
+ *     Benchmark of SWIG_InitializeModule loading many modules sharing one type
+ *     table, as when importing many SWIG extension modules into one
+ *     interpreter. Each synthetic module wraps its own classes derived from a
+ *     common Base, a few types used by all the modules and the classes of the
+ *     previous module, like a chain of %imports. The runtime code is the one in
+ *     Lib, built once with and once without SWIG_NO_TYPE_INDEX, and the type
+ *     table is checked once all the modules are loaded.
+ *
+ *     Usage: swig_init_bench [modules [classes]]
+ * ----------------------------------------------------------------------------- */
+
+#include "swiglabels.swg"
+#include "swigrun.swg"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* The interpreter state holding the list of modules */
+static swig_module_info *bench_modules = 0;
+#define SWIG_GetModule(clientdata) ((void)(clientdata), bench_modules)
+#define SWIG_SetModule(clientdata, pointer) (bench_modules = (pointer))
+
+/* The module being initialized, instead of the statics of a wrapper */
+static swig_module_info *bench_module;
+static swig_type_info **bench_type_initial;
+static swig_cast_info **bench_cast_initial;
+#define swig_module (*bench_module)
+#define swig_type_initial bench_type_initial
+#define swig_cast_initial bench_cast_initial
+
+#include "swiginit.swg"
+
+#define NSHARED 20
+
+static void *bench_upcast(void *ptr, int *newmemory) {
+  (void)newmemory;
+  return ptr;
+}
+
+static int compare_types(const void *a, const void *b) {
+  return strcmp((*(swig_type_info *const *)a)->name, (*(swig_type_info *const *)b)->name);
+}
+
+static char *class_name(int module, int klass) {
+  char *name = (char *)malloc(32);
+  sprintf(name, "_p_Mod%d_C%d", module, klass);
+  return name;
+}
+
+/* Generates the type and cast tables of module k, as SWIG would for it */
+static swig_module_info *generate(int k, int nclasses) {
+  int nimported = k ? nclasses : 0;
+  size_t size = 1 + NSHARED + nclasses + nimported;
+  swig_module_info *module = (swig_module_info *)calloc(1, sizeof(swig_module_info));
+  swig_type_info *types = (swig_type_info *)calloc(size, sizeof(swig_type_info));
+  swig_type_info **initial = (swig_type_info **)calloc(size, sizeof(swig_type_info *));
+  swig_cast_info **casts = (swig_cast_info **)calloc(size, sizeof(swig_cast_info *));
+  size_t i, n = 0;
+  int c;
+
+  types[n++].name = "_p_Base";
+  for (i = 0; i < NSHARED; ++i) {
+    char *name = (char *)malloc(32);
+    sprintf(name, "_p_shared%d", (int)i);
+    types[n++].name = name;
+  }
+  for (c = 0; c < nclasses; ++c)
+    types[n++].name = class_name(k, c);
+  for (c = 0; c < nimported; ++c)
+    types[n++].name = class_name(k - 1, c);
+  for (i = 0; i < size; ++i) {
+    types[i].str = types[i].name;
+    initial[i] = &types[i];
+  }
+  qsort(initial, size, sizeof(swig_type_info *), compare_types);
+
+  for (i = 0; i < size; ++i) {
+    swig_type_info *type = initial[i];
+    int base = (type == &types[0]);
+    size_t ncasts = base ? size - NSHARED : 1;
+    swig_cast_info *cast = (swig_cast_info *)calloc(ncasts + 1, sizeof(swig_cast_info));
+    cast[0].type = type;
+    if (base) {
+      size_t j;
+      for (j = 1; j < ncasts; ++j) {
+        cast[j].type = &types[NSHARED + j];
+        cast[j].converter = bench_upcast;
+      }
+    }
+    casts[i] = cast;
+  }
+
+  module->types = (swig_type_info **)calloc(size + 1, sizeof(swig_type_info *));
+  module->size = size;
+  bench_type_initial = initial;
+  bench_cast_initial = casts;
+  return module;
+}
+
+static swig_type_info *lookup(swig_module_info *module, const char *name) {
+  return SWIG_MangledTypeQueryModule(module, module->next, name);
+}
+
+/* Checks every class casts once to the single Base of the type table */
+static int check(swig_module_info **modules, int nmodules, int nclasses) {
+  swig_type_info *base = lookup(modules[0], "_p_Base");
+  swig_cast_info *cast;
+  long length = 0;
+  int k, c;
+  for (cast = base->cast; cast; cast = cast->next)
+    ++length;
+  if (length != 1 + (long)nmodules * nclasses) {
+    printf("Base has %ld casts, expected %ld\n", length, 1 + (long)nmodules * nclasses);
+    return 0;
+  }
+  for (k = 0; k < nmodules; ++k) {
+    if (lookup(modules[k], "_p_Base") != base || lookup(modules[k], "_p_shared0") != lookup(modules[0], "_p_shared0")) {
+      printf("module %d does not share the types\n", k);
+      return 0;
+    }
+    for (c = 0; c < nclasses; ++c) {
+      char *name = class_name(k, c);
+      swig_type_info *type = lookup(modules[k], name);
+      swig_cast_info *tc = SWIG_TypeCheckStruct(type, base);
+      if (!tc || !tc->converter || (k + 1 < nmodules && lookup(modules[k + 1], name) != type)) {
+        printf("no cast from %s to Base\n", name);
+        free(name);
+        return 0;
+      }
+      free(name);
+    }
+  }
+  return 1;
+}
+
+int main(int argc, char *argv[]) {
+  int nmodules = argc > 1 ? atoi(argv[1]) : 50;
+  int nclasses = argc > 2 ? atoi(argv[2]) : 200;
+  swig_type_info ***initial;
+  swig_cast_info ***casts;
+  swig_module_info **modules;
+  clock_t start;
+  double secs;
+  int k;
+
+  if (nmodules < 1 || nclasses < 1) {
+    printf("Usage: swig_init_bench [modules [classes]]\n");
+    return 2;
+  }
+  modules = (swig_module_info **)calloc(nmodules, sizeof(swig_module_info *));
+  initial = (swig_type_info ***)calloc(nmodules, sizeof(swig_type_info **));
+  casts = (swig_cast_info ***)calloc(nmodules, sizeof(swig_cast_info **));
+  for (k = 0; k < nmodules; ++k) {
+    modules[k] = generate(k, nclasses);
+    initial[k] = bench_type_initial;
+    casts[k] = bench_cast_initial;
+  }
+
+  start = clock();
+  for (k = 0; k < nmodules; ++k) {
+    bench_module = modules[k];
+    bench_type_initial = initial[k];
+    bench_cast_initial = casts[k];
+    SWIG_InitializeModule(0);
+  }
+  secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+#ifdef SWIG_NO_TYPE_INDEX
+  printf("%-24s", "module search");
+#else
+  printf("%-24s", "type index");
+#endif
+  printf(" %6d modules %6d classes %10.3f ms %10.1f us/module\n", nmodules, nclasses, secs * 1e3, secs * 1e6 / nmodules);
+  k = check(modules, nmodules, nclasses);
+  free(casts);
+  free(initial);
+  free(modules);
+  return k ? 0 : 1;
+}
@@ -0,0 +1,11 @@
+# Fails unless FILE contains a match of each regular expression in the list REGEX.
+# Used by the tests checking the code generated by swig:
+#   cmake -DFILE=<file> "-DREGEX=<regex>;<regex>..." -P CheckFileContents.cmake
+
+file (READ ${FILE} contents)
+foreach (regex IN LISTS REGEX)
+  string (REGEX MATCH "${regex}" match "${contents}")
+  if (NOT match)
+    message (FATAL_ERROR "${FILE} does not match '${regex}'")
+  endif ()
+endforeach ()